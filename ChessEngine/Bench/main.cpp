@@ -0,0 +1,228 @@
+#include "Core/Ai.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // Mix of opening, tactical middlegame and endgame positions
+    constexpr std::string_view SUITE[] = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+        "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "4rrk1/pp1n3p/3q2pQ/2p1pb2/2PP4/2P3N1/P2B2PP/4RRK1 b - - 7 19",
+        "2r3k1/1p3ppp/p3p3/3pP3/P2P4/1P3N2/5PPP/2R3K1 w - - 0 25",
+    };
+
+    struct RunResult {
+        double seconds = 0.0;
+        uint64_t nodes = 0;
+        uint64_t splits = 0;
+        uint64_t steals = 0;
+        double logNodes = 0.0;   // sum over positions, for the effective branching factor
+        int hashfull = 0;        // per mille, mean over positions
+        size_t hashMegabytes = 0;
+    };
+
+    struct StopLatency {
+        double meanMs = 0.0;
+        double maxMs = 0.0;
+    };
+
+    void printUsage()
+    {
+        std::cerr << "Usage: bench [-d depth] [-t threads,...] [-m smp|split] [-H hashMB] [-x pruning,...] [-s]\n"
+                  << "  -d  search depth for every position (default 7)\n"
+                  << "  -t  comma separated thread counts to compare (default 1)\n"
+                  << "  -m  parallel mode: smp (Lazy SMP, default) or split (Young Brothers Wait)\n"
+                  << "  -H  transposition table size in MB (default 16)\n"
+                  << "  -x  comma separated pruning to switch off: null, rfp, futility, razor\n"
+                  << "  -s  also measure how long stop() takes to return a move mid-search\n";
+    }
+
+    std::vector<unsigned> parseThreadList(const std::string& text)
+    {
+        std::vector<unsigned> counts;
+        std::stringstream stream(text);
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            counts.push_back(static_cast<unsigned>(std::max(1, std::atoi(item.c_str()))));
+        }
+        return counts;
+    }
+
+    // False on an unknown name
+    bool disablePruning(const std::string& text, Ai::PruningOptions& options)
+    {
+        std::stringstream stream(text);
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            if (item == "null") {
+                options.nullMove = false;
+            } else if (item == "rfp") {
+                options.reverseFutility = false;
+            } else if (item == "futility") {
+                options.futility = false;
+            } else if (item == "razor") {
+                options.razoring = false;
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Every position from a cleared table, so runs do not feed each other
+    RunResult runSuite(int depth, unsigned threads, Ai::ParallelMode mode, size_t hashMegabytes,
+                       const Ai::PruningOptions& pruning)
+    {
+        RunResult result;
+        Core board;
+        Ai ai(&board);
+        ai.setThreads(threads);
+        ai.setParallelMode(mode);
+        ai.setHashSize(hashMegabytes);
+        ai.setPruning(pruning);
+        result.hashMegabytes = ai.getHashSize();
+
+        Ai::SearchLimits limits;
+        limits.depth = depth;
+
+        for (const auto fen : SUITE) {
+            board.fromFEN(fen);
+            ai.clearHash();
+
+            const auto start = std::chrono::steady_clock::now();
+            (void)ai.findBestMove(board.snapshot(), limits);
+            result.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            const auto& stats = ai.lastSearch();
+            result.nodes += stats.nodes;
+            result.splits += stats.splits;
+            result.steals += stats.steals;
+            result.logNodes += std::log(static_cast<double>(std::max<uint64_t>(stats.nodes, 1)));
+            result.hashfull += stats.hashfull;
+        }
+        result.hashfull /= static_cast<int>(std::size(SUITE));
+        return result;
+    }
+
+    // Every position searched on the engine thread without limits, stopped after a
+    // while: the time stop() needs to hand back a move, from the call to its return
+    StopLatency measureStop(unsigned threads, Ai::ParallelMode mode, size_t hashMegabytes,
+                            const Ai::PruningOptions& pruning)
+    {
+        constexpr int SEARCH_MS = 200;
+
+        StopLatency latency;
+        Core board;
+        Ai ai(&board);
+        ai.setOption(Ai::EngineOption::Threads, threads);
+        ai.setOption(Ai::EngineOption::ParallelMode, static_cast<int64_t>(mode));
+        ai.setOption(Ai::EngineOption::HashMegabytes, static_cast<int64_t>(hashMegabytes));
+        ai.setPruning(pruning);
+        ai.setLimits(Ai::SearchLimits{});
+
+        for (const auto fen : SUITE) {
+            board.fromFEN(fen);
+            ai.setPosition(board.snapshot());
+            ai.go();
+            std::this_thread::sleep_for(std::chrono::milliseconds(SEARCH_MS));
+
+            const auto start = std::chrono::steady_clock::now();
+            (void)ai.stop();
+            const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            latency.meanMs += ms / static_cast<double>(std::size(SUITE));
+            latency.maxMs = std::max(latency.maxMs, ms);
+        }
+        return latency;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int depth = 7;
+    std::vector<unsigned> threadCounts{ 1 };
+    Ai::ParallelMode mode = Ai::ParallelMode::LazySmp;
+    size_t hashMegabytes = 16;
+    Ai::PruningOptions pruning;
+    bool stopCheck = false;
+
+    for (int arg = 1; arg < argc; ++arg) {
+        const std::string_view option = argv[arg];
+        if (option == "-d" && arg + 1 < argc) {
+            depth = std::max(1, std::atoi(argv[++arg]));
+        } else if (option == "-t" && arg + 1 < argc) {
+            threadCounts = parseThreadList(argv[++arg]);
+        } else if (option == "-m" && arg + 1 < argc) {
+            const std::string_view name = argv[++arg];
+            if (name == "split") {
+                mode = Ai::ParallelMode::SplitPoint;
+            } else if (name != "smp") {
+                printUsage();
+                return EXIT_FAILURE;
+            }
+        } else if (option == "-H" && arg + 1 < argc) {
+            hashMegabytes = static_cast<size_t>(std::max(1, std::atoi(argv[++arg])));
+        } else if (option == "-s") {
+            stopCheck = true;
+        } else if (option == "-x" && arg + 1 < argc) {
+            if (!disablePruning(argv[++arg], pruning)) {
+                printUsage();
+                return EXIT_FAILURE;
+            }
+        } else {
+            printUsage();
+            return EXIT_FAILURE;
+        }
+    }
+    if (threadCounts.empty()) {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    // The single-threaded search is the reference every row is compared to
+    const RunResult reference = runSuite(depth, 1, mode, hashMegabytes, pruning);
+
+    std::cout << "Positions: " << std::size(SUITE) << "  Depth: " << depth
+              << "  Mode: " << (mode == Ai::ParallelMode::SplitPoint ? "split" : "smp")
+              << "  Hash: " << reference.hashMegabytes << " MB\n\n"
+              << "Threads  time(ms)  nodes  nodes/sec  EBF  speedup  efficiency(%)  splits  steals  hashfull(permille)\n";
+
+    for (const unsigned threads : threadCounts) {
+        const RunResult run = (threads == 1) ? reference : runSuite(depth, threads, mode, hashMegabytes, pruning);
+        const double speedup = run.seconds > 0.0 ? reference.seconds / run.seconds : 0.0;
+        // nodes = EBF^depth, geometric mean over the suite
+        const double branching = std::exp(run.logNodes / static_cast<double>(std::size(SUITE)) / depth);
+        std::cout << threads
+                  << "  " << static_cast<uint64_t>(run.seconds * 1000.0)
+                  << "  " << run.nodes
+                  << "  " << (run.seconds > 0.0 ? static_cast<uint64_t>(static_cast<double>(run.nodes) / run.seconds) : 0)
+                  << "  " << branching
+                  << "  " << speedup
+                  << "  " << (100.0 * speedup / threads)
+                  << "  " << run.splits
+                  << "  " << run.steals
+                  << "  " << run.hashfull << "\n";
+    }
+
+    if (stopCheck) {
+        std::cout << "\nThreads  stop mean(ms)  stop max(ms)\n";
+        for (const unsigned threads : threadCounts) {
+            const StopLatency latency = measureStop(threads, mode, hashMegabytes, pruning);
+            std::cout << threads << "  " << latency.meanMs << "  " << latency.maxMs << "\n";
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -1,11 +1,9 @@
 #include "Controller.h"
 
+#include <algorithm>
 #include <optional>
 #include <string>
 #include <vector>
-#include <thread>
-#include <future>
-#include <chrono>
 
 namespace
 {
@@ -151,6 +149,10 @@ void Controller::startGame(Io *io, Core *core, Ai *ai)
     // ?? NEW VARIABLE: toggle this for AI vs AI mode
     bool aiVsAi = true; // set to true for AI vs AI, false for Human vs AI
 
+    // Human vs AI: keep searching on the human's time, on the reply the AI expects
+    const bool ponderEnabled = true;
+    std::optional<Ai::Move> expectedReply;
+
     while (!io->shouldClose())
     {
         io->beginFrame();
@@ -186,36 +188,52 @@ void Controller::startGame(Io *io, Core *core, Ai *ai)
         if (isAiTurn)
         {
 
-            if (!ai->aiThinking) {
-                SIDE sideForThisTurn = toMove;
-                ai->aiThinking = true;
-
-                ai->aiFuture = std::async(std::launch::async, [ai, core, sideForThisTurn]() -> auto {
-                    // Prefer: Position pos = core->snapshot(); return ai->findBestMove(pos, sideForThisTurn);
-                    return ai->findBestMove(*core, sideForThisTurn);
-                    });
+            if (!ai->isThinking()) {
+                // A copy: the search never touches the board the UI keeps drawing
+                ai->setPosition(core->snapshot());
+                ai->go();
             }
 
-            // 2) Non-blocking check for completion
-            if (ai->aiFuture.valid() &&
-                ai->aiFuture.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready)
+            // 2) Non-blocking check for completion, progress reports are skipped
+            Ai::SearchReport report;
+            if (ai->pollReport(report) && report.finished)
             {
-                auto optMove = ai->aiFuture.get();
-                ai->aiThinking = false;
-
-                if (optMove) {
-                    const BoardCell movingPiece = core->At(optMove->from);
-                    const BoardCell capturedPiece = core->At(optMove->to);
+                if (report.hasMove) {
+                    const Ai::Move& aiMove = report.bestMove;
+                    const BoardCell movingPiece = core->At(aiMove.from);
+                    const BoardCell capturedPiece = core->At(aiMove.to);
                     const SIDE opponent = (toMove == SIDE::WHITE_SIDE) ? SIDE::BLACK_SIDE : SIDE::WHITE_SIDE;
 
-                    if (core->movePiece(optMove->from, optMove->to)) {
+                    // Play the engine's own promotion choice, underpromotions included
+                    const PIECE promotion = (aiMove.promotion == PIECE::King) ? PIECE::Queen : aiMove.promotion;
+                    if (core->movePiece(aiMove.from, aiMove.to, promotion)) {
                         bool givesCheck = core->isKingInCheck(opponent);
                         moveHistory.push_back(
-                            buildMoveNotation(optMove->from, optMove->to,
+                            buildMoveNotation(aiMove.from, aiMove.to,
                                 movingPiece, capturedPiece, givesCheck));
                         toMove = opponent;
                         hasSelection = false;
                         io->getPossibleMovesToRender().clear();
+
+                        // Search the position after the expected reply until the human moves
+                        expectedReply.reset();
+                        if (ponderEnabled && !aiVsAi && report.hasPonderMove)
+                        {
+                            // The guess comes from the engine's board: only play it if it
+                            // is legal on ours, makeMove does not validate
+                            Core guess = *core;
+                            MoveList replies;
+                            guess.generateLegalMoves(guess.sideToMove(), replies);
+                            const bool legal = std::find(replies.begin(), replies.end(), report.ponderMove) != replies.end();
+                            if (legal)
+                            {
+                                (void)guess.makeMove(report.ponderMove);
+                                if (ai->ponder(guess.snapshot()))
+                                {
+                                    expectedReply = report.ponderMove;
+                                }
+                            }
+                        }
                     }
                 }
             }
@@ -255,6 +273,23 @@ void Controller::startGame(Io *io, Core *core, Ai *ai)
                                               : SIDE::WHITE_SIDE;
                     if (core->movePiece(selected, clicked))
                     {
+                        // The UI promotes to a queen: a hit keeps the ponder search
+                        // going as the real one, a miss drops it for a fresh search
+                        if (ai != nullptr && ai->isPondering())
+                        {
+                            const bool hit = expectedReply && expectedReply->from == selected && expectedReply->to == clicked
+                                && (expectedReply->promotion == PIECE::King || expectedReply->promotion == PIECE::Queen);
+                            if (hit)
+                            {
+                                ai->ponderHit();
+                            }
+                            else
+                            {
+                                (void)ai->stop();
+                            }
+                        }
+                        expectedReply.reset();
+
                         bool givesCheck = core->isKingInCheck(opponent);
                         moveHistory.push_back(
                             buildMoveNotation(selected, clicked,
@@ -281,6 +316,12 @@ void Controller::startGame(Io *io, Core *core, Ai *ai)
 
         io->endFrame();
     }
+
+    // Window closed mid-search: cut it short instead of waiting for the clock
+    if (ai != nullptr)
+    {
+        (void)ai->stop();
+    }
 }
 
 
@@ -1,52 +1,288 @@
 #include "Ai.h"
 #include <algorithm>
+#include <array>
+#include <cmath>
 #include <cstring>
+#include <functional>
+#include <span>
 
 static constexpr int INF = 1000000000;
+static constexpr int MATE_SCORE = 1000000;
+// Anything beyond this is a forced mate, stored relative to the node in the TT
+static constexpr int MATE_BOUND = MATE_SCORE - Ai::MAX_PLY;
 
-// Piece value lookup table (cache-friendly)
+// Move ordering bands, best first: hash move, winning or even captures and
+// promotions, the two killers, quiet moves by history, losing captures
+static constexpr int TT_MOVE_SCORE = 1 << 30;
+static constexpr int GOOD_CAPTURE_SCORE = 1 << 20;
+static constexpr int KILLER_SCORE = 1 << 19;
+static constexpr int BAD_CAPTURE_SCORE = -(1 << 20);
+// History scores saturate here through the gravity update
+static constexpr int MAX_HISTORY = 16384;
+// Null-move pruning: minimum depth, and depth from which a cutoff is verified
+static constexpr int NULL_MOVE_MIN_DEPTH = 3;
+static constexpr int NULL_MOVE_VERIFY_DEPTH = 8;
+// Late move reductions start with this move index, from this depth on
+static constexpr int LMR_MIN_MOVES = 3;
+static constexpr int LMR_MIN_DEPTH = 3;
+// Late move pruning: quiet moves past 3 + depth^2 are skipped up to this depth
+static constexpr int LMP_MAX_DEPTH = 3;
+// Reverse futility pruning: static eval margin over beta per ply, up to this depth
+static constexpr int REVERSE_FUTILITY_MARGIN = 120;
+static constexpr int REVERSE_FUTILITY_MAX_DEPTH = 6;
+// Futility pruning of quiet moves: static eval margin under alpha per ply
+static constexpr int FUTILITY_MARGIN = 150;
+static constexpr int FUTILITY_MAX_DEPTH = 3;
+// Razoring: static eval margin under alpha per ply before dropping into quiescence
+static constexpr int RAZOR_MARGIN = 300;
+static constexpr int RAZOR_MAX_DEPTH = 2;
+// Aspiration windows: first half width around the last score, and from which depth
+static constexpr int ASPIRATION_WINDOW = 25;
+static constexpr int ASPIRATION_MIN_DEPTH = 4;
+// Quiescence skips a capture that cannot lift the score to alpha even with this to spare
+static constexpr int DELTA_MARGIN = 200;
+
+// Piece value lookup table (cache-friendly), indexed by PIECE
 static constexpr int PIECE_VALUES[6] = {
-    100,   // Pion
-    320,   // Knight
+    20000, // King
+    900,   // Queen
     330,   // Bishop
+    320,   // Knight
     500,   // Rook
-    900,   // Queen
-    20000  // King
+    100    // Pion
 };
 
+namespace
+{
+    // Mate scores are stored as distance from the node rather than from the root,
+    // so the entry stays correct when the position is reached at another ply
+    int scoreToTT(int score, int ply)
+    {
+        if (score >= MATE_BOUND) return score + ply;
+        if (score <= -MATE_BOUND) return score - ply;
+        return score;
+    }
+
+    int scoreFromTT(int score, int ply)
+    {
+        if (score >= MATE_BOUND) return score - ply;
+        if (score <= -MATE_BOUND) return score + ply;
+        return score;
+    }
+
+    // Reduction in plies for the moveIndex-th move at a given depth, grows with
+    // log(depth) * log(moveIndex): late moves in deep trees rarely matter
+    using ReductionTable = std::array<std::array<int8_t, MoveList::CAPACITY>, Ai::MAX_DEPTH + 1>;
+
+    const ReductionTable LMR_TABLE = []() {
+        ReductionTable table{};
+        for (int depth = 1; depth <= Ai::MAX_DEPTH; ++depth) {
+            for (int moveIndex = 1; moveIndex < MoveList::CAPACITY; ++moveIndex) {
+                table[depth][moveIndex] = static_cast<int8_t>(0.75 + std::log(depth) * std::log(moveIndex) / 2.25);
+            }
+        }
+        return table;
+    }();
+
+    struct TimeBudget {
+        int64_t softMs;   // do not start another iteration past this
+        int64_t hardMs;   // abort the running iteration here
+        bool fixed;       // movetime: spent in full, no early exit
+    };
+
+    // 0/0 when the limits carry no time at all
+    TimeBudget planTime(const Ai::SearchLimits& limits)
+    {
+        if (limits.movetimeMs > 0) {
+            return { limits.movetimeMs, limits.movetimeMs, true };
+        }
+        if (limits.timeLeftMs <= 0) {
+            return { 0, 0, false };
+        }
+
+        // Spread the clock over the moves left (a guess in sudden death), plus most of
+        // the increment. Keep a safety margin so the flag never falls.
+        constexpr int64_t OVERHEAD_MS = 30;
+        const int64_t movesLeft = limits.movesToGo > 0 ? limits.movesToGo : 30;
+        const int64_t usable = std::max<int64_t>(1, limits.timeLeftMs - OVERHEAD_MS);
+        const int64_t soft = std::min(usable, usable / movesLeft + limits.incrementMs * 3 / 4);
+        const int64_t hard = std::min(usable, std::max(soft, std::min(soft * 4, usable / 3)));
+        return { std::max<int64_t>(1, soft), std::max<int64_t>(1, hard), false };
+    }
+}
+
 Ai::Ai(Core* corePtr)
     : core(corePtr)
 {
 }
 
-// Optimized: reuse allocated vector
-void Ai::generateAllMovesInto(const Core& board, SIDE side, std::vector<Move>& moves) const {
-    moves.clear();
-    const uint8_t sideValue = static_cast<uint8_t>(side);
+Ai::~Ai() {
+    if (engineThread.joinable()) {
+        (void)stop();
+        EngineCommand quit;
+        quit.type = EngineCommand::Type::Quit;
+        while (!post(quit)) {
+            std::this_thread::yield();
+        }
+        engineThread.join();
+    }
+    stopHelpers();
+}
 
-    // Single loop, minimal branches
-    for (const Vec2& from : board.filledCell) {
-        const BoardCell& c = board.At(from);
-        if (c.fill == 1 && c.side == sideValue) {
-            const auto& tos = board.getPossibleMoves(from);
-            const size_t oldSize = moves.size();
-            const size_t newSize = oldSize + tos.size();
+bool Ai::post(const EngineCommand& command) {
+    if (!engineThread.joinable()) {
+        engineThread = std::thread(&Ai::engineLoop, this);
+    }
+    if (!commands.push(command)) {
+        return false;
+    }
+    commandSignal.fetch_add(1, std::memory_order_release);
+    commandSignal.notify_one();
+    return true;
+}
 
-            // Batch resize once
-            moves.resize(newSize);
+bool Ai::setPosition(Position root) {
+    EngineCommand command;
+    command.type = EngineCommand::Type::Position;
+    command.position = root;
+    return post(command);
+}
+
+bool Ai::go() {
+    return go(limits);
+}
+
+bool Ai::go(const SearchLimits& searchLimits) {
+    return postGo(searchLimits, false);
+}
+
+bool Ai::ponder(Position root) {
+    // Up before the Go is queued, so the search never sees a stale value
+    pondering.store(true, std::memory_order_release);
+    if (!setPosition(root) || !postGo(limits, true)) {
+        pondering.store(false, std::memory_order_release);
+        return false;
+    }
+    return true;
+}
+
+void Ai::ponderHit() {
+    pondering.store(false, std::memory_order_release);
+}
+
+bool Ai::postGo(const SearchLimits& searchLimits, bool ponder) {
+    EngineCommand command;
+    command.type = EngineCommand::Type::Go;
+    command.limits = searchLimits;
+    command.searchId = lastSearchId + 1;
+    command.ponder = ponder;
+    if (!post(command)) {
+        return false;
+    }
+    lastSearchId = command.searchId;
+    thinking = true;
+    return true;
+}
+
+bool Ai::setOption(EngineOption option, int64_t value) {
+    EngineCommand command;
+    command.type = EngineCommand::Type::SetOption;
+    command.option = option;
+    command.value = value;
+    return post(command);
+}
 
-            // Direct memory copy for Move structs
-            Move* dest = moves.data() + oldSize;
-            for (size_t i = 0; i < tos.size(); ++i) {
-                dest[i] = Move{ from, tos[i] };
+std::optional<Ai::Move> Ai::stop() {
+    if (!thinking) {
+        return std::nullopt;
+    }
+
+    // The flag reaches the running search at once, the Stop command behind the Go
+    // lowers it again once that search is over
+    stopRequested.store(true, std::memory_order_relaxed);
+    EngineCommand command;
+    command.type = EngineCommand::Type::Stop;
+    while (!post(command)) {
+        std::this_thread::yield();
+    }
+
+    SearchReport report;
+    while (!pollReport(report) || !report.finished) {
+        std::this_thread::yield();
+    }
+    pondering.store(false, std::memory_order_release);
+    return report.hasMove ? std::optional<Move>(report.bestMove) : std::nullopt;
+}
+
+bool Ai::pollReport(SearchReport& report) {
+    SearchReport latest;
+    if (!reports.read(latest) || latest.searchId != lastSearchId) {
+        return false;
+    }
+    if (latest.finished) {
+        thinking = false;
+    }
+    report = latest;
+    return true;
+}
+
+void Ai::engineLoop() {
+    for (;;) {
+        // Read before popping: a push landing in between changes the signal and
+        // the wait below returns at once
+        const uint32_t seen = commandSignal.load(std::memory_order_acquire);
+        EngineCommand command;
+        if (!commands.pop(command)) {
+            commandSignal.wait(seen, std::memory_order_acquire);
+            continue;
+        }
+
+        switch (command.type) {
+        case EngineCommand::Type::Position:
+            enginePosition = command.position;
+            break;
+        case EngineCommand::Type::Go: {
+            runningSearchId = command.searchId;
+            ponderSearch = command.ponder;
+            const std::optional<Move> move = findBestMove(enginePosition, command.limits);
+            ponderSearch = false;
+            SearchReport report;
+            report.searchId = command.searchId;
+            report.finished = true;
+            report.hasMove = move.has_value();
+            report.bestMove = move.value_or(Move{});
+            report.hasPonderMove = ponderReply.has_value();
+            report.ponderMove = ponderReply.value_or(Move{});
+            report.stats = stats;
+            reports.publish(report);
+            break;
+        }
+        case EngineCommand::Type::Stop:
+            stopRequested.store(false, std::memory_order_relaxed);
+            break;
+        case EngineCommand::Type::SetOption:
+            // Between searches by construction, the queue runs one command at a time
+            if (command.option == EngineOption::Threads) {
+                threadCount = command.value > 0 ? static_cast<unsigned>(command.value) : 1;
+            } else if (command.option == EngineOption::HashMegabytes) {
+                tt.resize(static_cast<size_t>(command.value));
+            } else {
+                parallelMode = static_cast<ParallelMode>(command.value);
             }
+            break;
+        case EngineCommand::Type::Quit:
+            return;
         }
     }
 }
 
-std::vector<Ai::Move> Ai::generateAllMoves(const Core& board, SIDE side) const {
-    std::vector<Move> moves;
-    moves.reserve(40);
+// Writes straight into a stack buffer, every move coming back is already legal
+void Ai::generateAllMovesInto(const Core& board, SIDE side, MoveList& moves) const {
+    board.generateLegalMoves(side, moves);
+}
+
+MoveList Ai::generateAllMoves(const Core& board, SIDE side) const {
+    MoveList moves;
     generateAllMovesInto(board, side, moves);
     return moves;
 }
@@ -56,128 +292,836 @@ inline int Ai::pieceValue(PIECE p) const {
     return PIECE_VALUES[static_cast<int>(p)];
 }
 
-// Optimized evaluation with minimal branching
+// Material from the piece counts, no board walk
 int Ai::evaluate(const Core& board) const {
     int score = 0;
-    const uint8_t whiteSide = static_cast<uint8_t>(SIDE::WHITE_SIDE);
-
-    for (const Vec2& pos : board.filledCell) {
-        const BoardCell& cell = board.At(pos);
-        if (cell.fill == 0) continue;
-
-        const int value = PIECE_VALUES[cell.piece];
-        // Branchless: (side == white) ? +value : -value
-        score += value * (1 - 2 * (cell.side != whiteSide));
+    for (uint8_t p = 0; p < 6; ++p) {
+        const PIECE piece = static_cast<PIECE>(p);
+        score += PIECE_VALUES[p] * (board.countOf(SIDE::WHITE_SIDE, piece) - board.countOf(SIDE::BLACK_SIDE, piece));
     }
     return score;
 }
 
-// Key optimization: move ordering without sorting
+// Captures and promotions only, quiet moves score 0 and are ranked by the caller
 inline int Ai::scoreMoveForOrdering(const Core& board, const Move& m) const {
-    const BoardCell& target = board.At(m.to);
-    if (target.fill == 0) return 0;
+    // A promotion is worth the new piece on top of whatever it captures
+    const int promotion = (m.promotion != PIECE::King) ? PIECE_VALUES[static_cast<int>(m.promotion)] : 0;
 
-    // MVV-LVA: Most Valuable Victim - Least Valuable Attacker
+    const BoardCell& target = board.At(m.to);
     const BoardCell& attacker = board.At(m.from);
-    return PIECE_VALUES[target.piece] * 10 - PIECE_VALUES[attacker.piece];
+    if (target.fill == 0) {
+        // En passant is a pawn trade like any other pawn capture
+        const bool enPassant = attacker.piece == static_cast<uint8_t>(PIECE::Pion) && m.from.x != m.to.x;
+        if (enPassant) return GOOD_CAPTURE_SCORE + PIECE_VALUES[static_cast<int>(PIECE::Pion)] * 10 - PIECE_VALUES[static_cast<int>(PIECE::Pion)];
+        return promotion ? GOOD_CAPTURE_SCORE + promotion : 0;
+    }
+
+    // MVV-LVA: Most Valuable Victim - Least Valuable Attacker. The king counts as
+    // the cheapest attacker, it can only take undefended pieces anyway.
+    const bool kingCapture = attacker.piece == static_cast<uint8_t>(PIECE::King);
+    const int attackerValue = kingCapture ? 0 : PIECE_VALUES[attacker.piece];
+
+    // A cheaper piece taking a dearer one never loses material, nor does a legal
+    // king capture. Otherwise let the exchange decide: a losing capture scores
+    // below every quiet move.
+    if (!kingCapture && PIECE_VALUES[target.piece] < PIECE_VALUES[attacker.piece]) {
+        const int exchange = board.see(m);
+        if (exchange < 0) return BAD_CAPTURE_SCORE + exchange;
+    }
+
+    return GOOD_CAPTURE_SCORE + PIECE_VALUES[target.piece] * 10 - attackerValue + promotion;
 }
 
-int Ai::negamax(Core board, int depth, SIDE side, int alpha, int beta) const {
-    if (depth == 0) {
-        int val = evaluate(board);
-        return (side == SIDE::WHITE_SIDE) ? val : -val;
+bool Ai::isQuiet(const Core& board, const Move& m) {
+    if (board.At(m.to).fill != 0 || m.promotion != PIECE::King) return false;
+    const BoardCell& mover = board.At(m.from);
+    return !(mover.piece == static_cast<uint8_t>(PIECE::Pion) && m.from.x != m.to.x);
+}
+
+// Gravity: the bonus shrinks as the score nears MAX_HISTORY, so the table never
+// saturates and recent cutoffs outweigh old ones
+void Ai::updateHistory(int& entry, int bonus) {
+    entry += bonus - entry * std::abs(bonus) / MAX_HISTORY;
+}
+
+void Ai::armClock() {
+    const auto now = std::chrono::steady_clock::now();
+    clockArmed = true;
+    hasDeadline = hardBudgetMs > 0;
+    deadline = fixedBudget ? std::max(now, searchStart + std::chrono::milliseconds(hardBudgetMs))
+        : now + std::chrono::milliseconds(hardBudgetMs);
+    // Pondered past what the move was worth: answer with the last full iteration
+    if (softBudgetMs > 0 && now - searchStart >= std::chrono::milliseconds(softBudgetMs)) {
+        stopped.store(true, std::memory_order_relaxed);
     }
+}
 
-    // Thread-local move buffer (zero allocation in recursion)
-    static thread_local std::vector<Move> moves;
-    static thread_local std::vector<int> moveScores;
+void Ai::checkTime() {
+    if (!clockArmed && !pondering.load(std::memory_order_acquire)) {
+        armClock();
+    }
+    if (stopRequested.load(std::memory_order_relaxed)
+        || (hasDeadline && std::chrono::steady_clock::now() >= deadline)) {
+        stopped.store(true, std::memory_order_relaxed);
+    }
+}
 
-    generateAllMovesInto(board, side, moves);
+bool Ai::aborted(const SearchContext& ctx) const {
+    if (stopped.load(std::memory_order_relaxed)) {
+        return true;
+    }
+    for (const SplitPoint* sp = ctx.split; sp != nullptr; sp = sp->parent) {
+        if (sp->cutoff.load(std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
 
-    if (moves.empty()) {
-        int val = evaluate(board);
-        return (side == SIDE::WHITE_SIDE) ? val : -val;
+bool Ai::hasNonPawnMaterial(const Core& board, SIDE side) {
+    return board.countOf(side, PIECE::Knight) + board.countOf(side, PIECE::Bishop)
+        + board.countOf(side, PIECE::Rook) + board.countOf(side, PIECE::Queen) > 0;
+}
+
+int Ai::negamax(SearchContext& ctx, int depth, int ply, SIDE side, int alpha, int beta, bool allowNull) {
+    if ((++ctx.nodes % TIME_CHECK_INTERVAL) == 0 && ctx.index == 0) {
+        checkTime();
+    }
+    // The value is thrown away by every caller once aborted
+    if (aborted(ctx)) {
+        return 0;
+    }
+
+    Core& board = ctx.board;
+
+    if (depth == 0) {
+        return quiescence(ctx, ply, side, alpha, beta);
+    }
+
+    const uint64_t key = board.hash();
+    const int alphaOrig = alpha;
+
+    // A deep enough stored result may settle the node outright; otherwise its
+    // best move is still the first one worth trying
+    TranspositionTable::ProbeResult entry{};
+    const bool ttHit = tt.probe(key, entry);
+    if (ttHit && entry.depth >= depth) {
+        const int ttScore = scoreFromTT(entry.score, ply);
+        if (entry.bound == TranspositionTable::Bound::Exact
+            || (entry.bound == TranspositionTable::Bound::Lower && ttScore >= beta)
+            || (entry.bound == TranspositionTable::Bound::Upper && ttScore <= alpha)) {
+            return ttScore;
+        }
     }
 
-    const int moveCount = static_cast<int>(moves.size());
-    int best = -INF;
     const SIDE opp = (side == SIDE::WHITE_SIDE) ? SIDE::BLACK_SIDE : SIDE::WHITE_SIDE;
+    const bool inCheck = board.isKingInCheck(side);
+    // Zero-window nodes only: a principal variation node needs its exact score
+    const bool pvNode = beta - alpha > 1;
 
-    // Fast move ordering: score captures, then partial sort only what we need
-    if (moveCount > 1) {
-        moveScores.resize(moveCount);
-        for (int i = 0; i < moveCount; ++i) {
-            moveScores[i] = scoreMoveForOrdering(board, moves[i]);
-        }
-
-        // Partial sort: only ensure best moves are first (insertion sort for small lists)
-        if (moveCount <= 8) {
-            for (int i = 1; i < moveCount; ++i) {
-                int j = i;
-                while (j > 0 && moveScores[j] > moveScores[j-1]) {
-                    std::swap(moveScores[j], moveScores[j-1]);
-                    std::swap(moves[j], moves[j-1]);
-                    --j;
-                }
+    int staticEval = 0;
+    if (!inCheck) {
+        const int val = evaluate(board);
+        staticEval = (side == SIDE::WHITE_SIDE) ? val : -val;
+    }
+
+    // Reverse futility: so far above beta that a quiet move by the opponent is not
+    // going to bring the score back down within the remaining depth
+    if (pruning.reverseFutility && !pvNode && !inCheck && depth <= REVERSE_FUTILITY_MAX_DEPTH
+        && std::abs(beta) < MATE_BOUND && staticEval - REVERSE_FUTILITY_MARGIN * depth >= beta) {
+        return staticEval;
+    }
+
+    // Razoring: hopelessly below alpha near the leaves, let quiescence confirm that
+    // no capture rescues the position before dropping the node
+    if (pruning.razoring && !pvNode && !inCheck && depth <= RAZOR_MAX_DEPTH
+        && std::abs(alpha) < MATE_BOUND && staticEval + RAZOR_MARGIN * depth <= alpha) {
+        const int val = quiescence(ctx, ply, side, alpha, alpha + 1);
+        if (aborted(ctx)) {
+            return 0;
+        }
+        if (val <= alpha) {
+            return val;
+        }
+    }
+
+    // Null move: if passing the turn still fails high, a real move would too.
+    // Not in check (passing would be illegal), not without pieces (zugzwang), not
+    // twice in a row and not near mate scores.
+    if (pruning.nullMove && allowNull && !inCheck && depth >= NULL_MOVE_MIN_DEPTH && std::abs(beta) < MATE_BOUND
+        && hasNonPawnMaterial(board, side)) {
+        if (staticEval >= beta) {
+            // Deeper nodes and a larger margin over beta afford a bigger reduction
+            const int reduction = 3 + depth / 6 + std::min(3, (staticEval - beta) / 200);
+            const int nullDepth = std::max(0, depth - 1 - reduction);
+
+            const Core::UndoInfo undo = board.makeNullMove();
+            int score = -negamax(ctx, nullDepth, ply + 1, opp, -beta, -beta + 1, false);
+            board.unmakeNullMove(undo);
+
+            if (aborted(ctx)) {
+                return 0;
             }
-        } else {
-            // For larger move lists, only sort first N moves
-            constexpr int SORT_COUNT = 8;
-            for (int i = 0; i < std::min(SORT_COUNT, moveCount); ++i) {
-                int maxIdx = i;
-                for (int j = i + 1; j < moveCount; ++j) {
-                    if (moveScores[j] > moveScores[maxIdx]) {
-                        maxIdx = j;
+
+            if (score >= beta) {
+                // A mate found after passing proves nothing about the real moves
+                if (score >= MATE_BOUND) {
+                    score = beta;
+                }
+                // Deep cutoffs are checked by a reduced search of the node itself with
+                // null moves off, which catches zugzwang positions
+                if (depth >= NULL_MOVE_VERIFY_DEPTH) {
+                    const int verified = negamax(ctx, nullDepth, ply, side, beta - 1, beta, false);
+                    if (aborted(ctx)) {
+                        return 0;
+                    }
+                    if (verified < beta) {
+                        score = -INF;
                     }
                 }
-                if (maxIdx != i) {
-                    std::swap(moveScores[i], moveScores[maxIdx]);
-                    std::swap(moves[i], moves[maxIdx]);
+                if (score >= beta) {
+                    tt.store(key, depth, scoreToTT(score, ply), TranspositionTable::Bound::Lower, nullptr);
+                    return score;
                 }
             }
         }
     }
 
+    // Per-frame stack buffers: no allocation, and deeper plies cannot clobber this list
+    MoveList moves;
+    int moveScores[MoveList::CAPACITY];
+
+    generateAllMovesInto(board, side, moves);
+
+    // No legal move left: checkmate or stalemate. Mates closer to the root score
+    // further from zero.
+    if (moves.empty()) {
+        return inCheck ? -MATE_SCORE + ply : 0;
+    }
+
+    const int moveCount = moves.size();
+    int best = -INF;
+
+    // Move ordering: hash move, captures by MVV-LVA/SEE, killers, then quiet moves by history
+    const int sideIndex = static_cast<int>(side);
+    for (int i = 0; i < moveCount; ++i) {
+        const Move& m = moves[i];
+        if (ttHit && entry.hasMove && m == entry.move) {
+            moveScores[i] = TT_MOVE_SCORE;
+        } else if (!isQuiet(board, m)) {
+            moveScores[i] = scoreMoveForOrdering(board, m);
+        } else if (m == ctx.killers[ply][0]) {
+            moveScores[i] = KILLER_SCORE + 1;
+        } else if (m == ctx.killers[ply][1]) {
+            moveScores[i] = KILLER_SCORE;
+        } else {
+            moveScores[i] = ctx.history[sideIndex][toSquare(m.from)][toSquare(m.to)];
+        }
+    }
+
+    // Futility: even a margin per remaining ply on top of the static eval does not
+    // reach alpha, so only captures and promotions are worth searching
+    const bool futile = pruning.futility && !pvNode && !inCheck && depth <= FUTILITY_MAX_DEPTH
+        && std::abs(alpha) < MATE_BOUND && staticEval + FUTILITY_MARGIN * depth <= alpha;
+
+    // Quiet moves that did not cut off, penalised if a later quiet move does
+    Move quietsTried[MoveList::CAPACITY];
+    int quietCount = 0;
+
     // Search loop
+    int bestIndex = 0;
     for (int i = 0; i < moveCount; ++i) {
+        // Eldest brother searched and no cutoff: the rest may go in parallel. Sort
+        // what is left once, helpers read the list as it is.
+        if (i > 0 && parallelMode == ParallelMode::SplitPoint && threadCount > 1
+            && depth >= MIN_SPLIT_DEPTH && moveCount - i > 1) {
+            for (int j = i + 1; j < moveCount; ++j) {
+                for (int k = j; k > i && moveScores[k] > moveScores[k - 1]; --k) {
+                    std::swap(moveScores[k], moveScores[k - 1]);
+                    std::swap(moves[k], moves[k - 1]);
+                }
+            }
+            if (!splitSearch(ctx, moves, moveScores, inCheck, futile, i, depth, ply, side, alpha, beta, best, bestIndex,
+                             quietsTried, quietCount)) {
+                return 0;
+            }
+            break;
+        }
+
+        // Selection sort as we go, most nodes cut off after a move or two
+        int maxIdx = i;
+        for (int j = i + 1; j < moveCount; ++j) {
+            if (moveScores[j] > moveScores[maxIdx]) {
+                maxIdx = j;
+            }
+        }
+        std::swap(moveScores[i], moveScores[maxIdx]);
+        std::swap(moves[i], moves[maxIdx]);
+
         const Move& m = moves[i];
-        Core tmp = board;
-        if (!tmp.movePiece(m.from, m.to)) continue;
+        const bool quiet = isQuiet(board, m);
 
-        int val = -negamax(tmp, depth - 1, opp, -beta, -alpha);
+        // Late move pruning: near the leaves, once enough quiet moves have failed the
+        // rest are very unlikely to do better. Never before a move has been searched.
+        if (quiet && !inCheck && depth <= LMP_MAX_DEPTH && best > -MATE_BOUND
+            && quietCount >= 3 + depth * depth) {
+            continue;
+        }
+        // Futile quiet moves go once one move has given the node a score
+        if (futile && quiet && best > -MATE_BOUND) {
+            continue;
+        }
+
+        const int val = searchMove(ctx, m, i, moveScores[i], quiet, inCheck, depth, ply, side, alpha, beta);
+
+        // Partial result, must not reach the table
+        if (aborted(ctx)) {
+            return 0;
+        }
 
         if (val > best) {
             best = val;
+            bestIndex = i;
             if (val > alpha) {
                 alpha = val;
                 if (alpha >= beta) break; // Beta cutoff
             }
         }
+
+        if (quiet) {
+            quietsTried[quietCount++] = m;
+        }
+    }
+
+    // A quiet refutation becomes a killer for this ply and gains history, the quiet
+    // moves tried before it lose some
+    if (best >= beta && isQuiet(board, moves[bestIndex])) {
+        const Move& refutation = moves[bestIndex];
+        if (!(ctx.killers[ply][0] == refutation)) {
+            ctx.killers[ply][1] = ctx.killers[ply][0];
+            ctx.killers[ply][0] = refutation;
+        }
+        const int bonus = std::min(depth * depth, 1200);
+        updateHistory(ctx.history[sideIndex][toSquare(refutation.from)][toSquare(refutation.to)], bonus);
+        for (int i = 0; i < quietCount; ++i) {
+            updateHistory(ctx.history[sideIndex][toSquare(quietsTried[i].from)][toSquare(quietsTried[i].to)], -bonus);
+        }
+    }
+
+    const TranspositionTable::Bound bound = (best >= beta) ? TranspositionTable::Bound::Lower
+        : (best > alphaOrig) ? TranspositionTable::Bound::Exact
+        : TranspositionTable::Bound::Upper;
+    // A fail-low node has no move worth remembering
+    tt.store(key, depth, scoreToTT(best, ply), bound,
+             bound == TranspositionTable::Bound::Upper ? nullptr : &moves[bestIndex]);
+
+    return best;
+}
+
+int Ai::searchMove(SearchContext& ctx, const Move& m, int moveIndex, int moveScore, bool quiet, bool inCheck,
+                   int depth, int ply, SIDE side, int alpha, int beta) {
+    Core& board = ctx.board;
+    const SIDE opp = (side == SIDE::WHITE_SIDE) ? SIDE::BLACK_SIDE : SIDE::WHITE_SIDE;
+    const Core::UndoInfo undo = board.makeMove(m);
+    const bool givesCheck = board.isKingInCheck(opp);
+
+    // Principal variation search: the first move gets the full window, the
+    // others only have to prove they are no better than alpha, with a zero
+    // window that cuts off much sooner
+    int val;
+    if (moveIndex == 0) {
+        val = -negamax(ctx, depth - 1, ply + 1, opp, -beta, -alpha);
+    } else {
+        // Late move reductions: quiet moves and losing captures far down the list
+        // get a shallower scout first
+        int reduction = 0;
+        const bool losingCapture = !quiet && moveScore < 0;
+        if (moveIndex >= LMR_MIN_MOVES && depth >= LMR_MIN_DEPTH && !inCheck && !givesCheck && (quiet || losingCapture)) {
+            reduction = LMR_TABLE[std::min(depth, MAX_DEPTH)][moveIndex];
+            if (moveScore >= KILLER_SCORE) {
+                --reduction;
+            } else if (quiet) {
+                reduction -= moveScore / (MAX_HISTORY / 2);
+            }
+            reduction = std::clamp(reduction, 0, depth - 2);
+        }
+
+        val = -negamax(ctx, depth - 1 - reduction, ply + 1, opp, -alpha - 1, -alpha);
+        // Beat alpha while reduced: confirm at full depth, still with the scout window
+        if (reduction > 0 && val > alpha && !aborted(ctx)) {
+            val = -negamax(ctx, depth - 1, ply + 1, opp, -alpha - 1, -alpha);
+        }
+        // Inside the window: a new principal variation, get its exact score
+        if (val > alpha && val < beta && !aborted(ctx)) {
+            val = -negamax(ctx, depth - 1, ply + 1, opp, -beta, -alpha);
+        }
+    }
+
+    board.unmakeMove(m, undo);
+    return val;
+}
+
+int Ai::quiescence(SearchContext& ctx, int ply, SIDE side, int alpha, int beta) {
+    if ((++ctx.nodes % TIME_CHECK_INTERVAL) == 0 && ctx.index == 0) {
+        checkTime();
+    }
+    if (aborted(ctx)) {
+        return 0;
+    }
+
+    Core& board = ctx.board;
+    const bool inCheck = board.isKingInCheck(side);
+
+    // Stand pat: the side to move may decline every capture. Not an option in check.
+    int best = -INF;
+    int standPat = 0;
+    if (!inCheck) {
+        const int val = evaluate(board);
+        standPat = (side == SIDE::WHITE_SIDE) ? val : -val;
+        if (standPat >= beta || ply >= MAX_PLY) {
+            return standPat;
+        }
+        best = standPat;
+        alpha = std::max(alpha, standPat);
+    }
+
+    MoveList moves;
+    int moveScores[MoveList::CAPACITY];
+    board.generateLegalMoves(side, moves, inCheck ? Core::GenMode::All : Core::GenMode::Captures);
+
+    if (moves.empty()) {
+        return inCheck ? -MATE_SCORE + ply : standPat;
+    }
+
+    const int moveCount = moves.size();
+    for (int i = 0; i < moveCount; ++i) {
+        moveScores[i] = scoreMoveForOrdering(board, moves[i]);
+    }
+
+    const SIDE opp = (side == SIDE::WHITE_SIDE) ? SIDE::BLACK_SIDE : SIDE::WHITE_SIDE;
+    for (int i = 0; i < moveCount; ++i) {
+        // Selection sort as we go, a cutoff usually comes before the list is sorted
+        int maxIdx = i;
+        for (int j = i + 1; j < moveCount; ++j) {
+            if (moveScores[j] > moveScores[maxIdx]) {
+                maxIdx = j;
+            }
+        }
+        std::swap(moveScores[i], moveScores[maxIdx]);
+        std::swap(moves[i], moves[maxIdx]);
+
+        const Move& m = moves[i];
+
+        if (!inCheck) {
+            // Losing captures (negative SEE score) sort last: nothing left worth searching
+            if (moveScores[i] < 0) {
+                break;
+            }
+
+            // Delta pruning: even winning the victim outright leaves us below alpha
+            const BoardCell& target = board.At(m.to);
+            const int victim = target.fill ? PIECE_VALUES[target.piece] : PIECE_VALUES[static_cast<int>(PIECE::Pion)];
+            const int promotion = (m.promotion != PIECE::King)
+                ? PIECE_VALUES[static_cast<int>(m.promotion)] - PIECE_VALUES[static_cast<int>(PIECE::Pion)] : 0;
+            if (standPat + victim + promotion + DELTA_MARGIN <= alpha) {
+                continue;
+            }
+        }
+
+        const Core::UndoInfo undo = board.makeMove(m);
+        const int val = -quiescence(ctx, ply + 1, opp, -beta, -alpha);
+        board.unmakeMove(m, undo);
+
+        if (aborted(ctx)) {
+            return 0;
+        }
+
+        if (val > best) {
+            best = val;
+            if (val > alpha) {
+                alpha = val;
+                if (alpha >= beta) break;
+            }
+        }
     }
 
+    // Every capture was delta pruned: the stand pat bound is all we know
     return best;
 }
 
-std::optional<Ai::Move> Ai::findBestMove(const Core& rootBoard, SIDE sideToMove) {
-    std::vector<Move> moves;
-    moves.reserve(40);
+void Ai::searchSplitMoves(SearchContext& ctx, SplitPoint& sp) {
+    const Core& board = ctx.board;
+    const int moveCount = sp.moves->size();
+
+    // Covers a stop as well as a cutoff here or further up, no sibling is taken after either
+    while (!aborted(ctx)) {
+        const int i = sp.nextMove.fetch_add(1, std::memory_order_relaxed);
+        if (i >= moveCount) {
+            break;
+        }
+
+        const Move& m = (*sp.moves)[i];
+        const bool quiet = isQuiet(board, m);
+
+        // Same late move and futility rules as the serial loop in negamax
+        if (quiet && sp.best.load(std::memory_order_relaxed) > -MATE_BOUND) {
+            if (!sp.inCheck && sp.depth <= LMP_MAX_DEPTH
+                && sp.quietCount.load(std::memory_order_relaxed) >= 3 + sp.depth * sp.depth) {
+                continue;
+            }
+            if (sp.futile) {
+                continue;
+            }
+        }
+
+        // Alpha may have risen since the split, search with the latest one
+        const int alpha = sp.alpha.load(std::memory_order_relaxed);
+        // Never the first move of the node, so a reduced scout like any late sibling
+        const int val = searchMove(ctx, m, i, sp.moveScores[i], quiet, sp.inCheck,
+                                   sp.depth, sp.ply, sp.side, alpha, sp.beta);
+
+        if (aborted(ctx)) {
+            break;
+        }
+
+        // A quiet refutation is the owner's to reward, every other quiet move is
+        // penalised with the serial ones if the node cuts off
+        if (quiet && val < sp.beta) {
+            sp.quietsTried[sp.quietCount.fetch_add(1, std::memory_order_relaxed)] = m;
+        }
+
+        std::lock_guard<std::mutex> lock(sp.mutex);
+        if (val > sp.best.load(std::memory_order_relaxed)) {
+            sp.best.store(val, std::memory_order_relaxed);
+            sp.bestIndex = i;
+            if (val > sp.alpha.load(std::memory_order_relaxed)) {
+                sp.alpha.store(val, std::memory_order_relaxed);
+                if (val >= sp.beta) {
+                    // Every thread below this split point unwinds on its next node
+                    sp.cutoff.store(true, std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+}
+
+bool Ai::splitSearch(SearchContext& ctx, const MoveList& moves, const int* moveScores, bool inCheck, bool futile,
+                     int first, int depth, int ply, SIDE side, int& alpha, int beta, int& best, int& bestIndex,
+                     Move* quietsTried, int& quietCount) {
+    SplitPoint sp;
+    sp.board = ctx.board;
+    sp.moves = &moves;
+    sp.moveScores = moveScores;
+    sp.inCheck = inCheck;
+    sp.futile = futile;
+    sp.parent = ctx.split;
+    sp.side = side;
+    sp.depth = depth;
+    sp.ply = ply;
+    sp.beta = beta;
+    sp.nextMove.store(first, std::memory_order_relaxed);
+    sp.alpha.store(alpha, std::memory_order_relaxed);
+    sp.best.store(best, std::memory_order_relaxed);
+    sp.bestIndex = bestIndex;
+    sp.quietsTried = quietsTried;
+    sp.quietCount.store(quietCount, std::memory_order_relaxed);
+
+    // One task per other thread at most, the owner takes a share itself
+    const int offered = std::min(static_cast<int>(threadCount) - 1, moves.size() - first - 1);
+    sp.pending.store(offered, std::memory_order_relaxed);
+    for (int i = 0; i < offered; ++i) {
+        ctx.tasks.push(&sp);
+    }
+    ++ctx.splits;
+
+    SplitPoint* const outer = ctx.split;
+    ctx.split = &sp;
+    searchSplitMoves(ctx, sp);
+    ctx.split = outer;
+
+    // Take back what nobody stole (nested splits have drained their own tasks by
+    // now, so only ours are left), then wait for the helpers still busy on it.
+    // Meanwhile help them: split points opened below this one are fair game, their
+    // owners work for us and this frame outlives them.
+    auto belowThis = [&sp](const SplitPoint* candidate) {
+        for (const SplitPoint* p = candidate; p != nullptr; p = p->parent) {
+            if (p == &sp) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    SplitPoint* task = nullptr;
+    while (sp.pending.load(std::memory_order_acquire) > 0) {
+        if (ctx.tasks.pop(task)) {
+            sp.pending.fetch_sub(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        bool found = false;
+        for (unsigned offset = 1; offset < threadCount && !found; ++offset) {
+            found = contexts[(ctx.index + offset) % threadCount].tasks.stealIf(task, belowThis);
+        }
+        if (found) {
+            ++ctx.steals;
+            ctx.board = task->board;
+            ctx.split = task;
+            searchSplitMoves(ctx, *task);
+            ctx.split = outer;
+            ctx.board = sp.board;
+            task->pending.fetch_sub(1, std::memory_order_release);
+            continue;
+        }
+
+        // The main thread is the only clock reader: it must not go deaf while it waits
+        if (ctx.index == 0) {
+            checkTime();
+        }
+        std::this_thread::yield();
+    }
+
+    if (aborted(ctx)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(sp.mutex);
+    best = sp.best.load(std::memory_order_relaxed);
+    bestIndex = sp.bestIndex;
+    quietCount = sp.quietCount.load(std::memory_order_relaxed);
+    alpha = sp.alpha.load(std::memory_order_relaxed);
+    return true;
+}
+
+void Ai::startHelpers() {
+    const uint32_t seen = searchSignal.load(std::memory_order_relaxed);
+    helperThreads.reserve(threadCount - 1);
+    for (unsigned i = 1; i < threadCount; ++i) {
+        helperThreads.emplace_back(&Ai::helperLoop, this, i, seen);
+    }
+}
+
+void Ai::stopHelpers() {
+    if (helperThreads.empty()) {
+        return;
+    }
+    helpersQuit = true;
+    searchSignal.fetch_add(1, std::memory_order_release);
+    searchSignal.notify_all();
+    for (auto& helper : helperThreads) {
+        helper.join();
+    }
+    helperThreads.clear();
+    helpersQuit = false;
+}
+
+void Ai::helperLoop(unsigned index, uint32_t seen) {
+    for (;;) {
+        searchSignal.wait(seen, std::memory_order_acquire);
+        // No second bump can come before this helper reports back below
+        seen = searchSignal.load(std::memory_order_acquire);
+        if (helpersQuit) {
+            return;
+        }
+
+        SearchContext& ctx = contexts[index];
+        if (parallelMode == ParallelMode::SplitPoint) {
+            workerLoop(ctx);
+        } else {
+            helperSearch(ctx, helperSide, helperMoves, helperMaxDepth);
+        }
+
+        if (helpersRunning.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            helpersRunning.notify_one();
+        }
+    }
+}
+
+void Ai::workerLoop(SearchContext& ctx) {
+    const unsigned count = threadCount;
+    SplitPoint* sp = nullptr;
+
+    while (!stopped.load(std::memory_order_relaxed)) {
+        bool found = false;
+        for (unsigned offset = 1; offset < count && !found; ++offset) {
+            found = contexts[(ctx.index + offset) % count].tasks.steal(sp);
+        }
+        if (!found) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        ++ctx.steals;
+        ctx.board = sp->board;
+        ctx.split = sp;
+        searchSplitMoves(ctx, *sp);
+        ctx.split = nullptr;
+        sp->pending.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+bool Ai::searchRoot(SearchContext& ctx, SIDE side, int depth, int alpha, int beta,
+                    MoveList& moves, Move& bestMove, int& bestScore) {
+    Core& board = ctx.board;
+    const SIDE opp = (side == SIDE::WHITE_SIDE) ? SIDE::BLACK_SIDE : SIDE::WHITE_SIDE;
+    const int alphaOrig = alpha;
+    bestScore = -INF;
+
+    for (uint16_t i = 0; i < moves.size(); ++i) {
+        const Move& m = moves[i];
+        const Core::UndoInfo undo = board.makeMove(m);
+        int val;
+        if (i == 0) {
+            val = -negamax(ctx, depth - 1, 1, opp, -beta, -alpha);
+        } else {
+            val = -negamax(ctx, depth - 1, 1, opp, -alpha - 1, -alpha);
+            if (val > alpha && val < beta && !aborted(ctx)) {
+                val = -negamax(ctx, depth - 1, 1, opp, -beta, -alpha);
+            }
+        }
+        board.unmakeMove(m, undo);
+
+        if (aborted(ctx)) {
+            return false;
+        }
+
+        if (val > bestScore) {
+            bestScore = val;
+            bestMove = m;
+            if (val > alpha) {
+                alpha = val;
+                if (alpha >= beta) break;
+            }
+        }
+    }
+
+    const TranspositionTable::Bound bound = (bestScore >= beta) ? TranspositionTable::Bound::Lower
+        : (bestScore > alphaOrig) ? TranspositionTable::Bound::Exact
+        : TranspositionTable::Bound::Upper;
+    tt.store(board.hash(), depth, scoreToTT(bestScore, 0), bound,
+             bound == TranspositionTable::Bound::Upper ? nullptr : &bestMove);
+    return true;
+}
+
+bool Ai::aspirationSearch(SearchContext& ctx, SIDE side, int depth, int previousScore,
+                          MoveList& moves, Move& bestMove, int& bestScore) {
+    // Shallow iterations are cheap and their scores jump around, and mate scores
+    // have nothing to centre a window on
+    int delta = ASPIRATION_WINDOW;
+    int alpha = -INF;
+    int beta = INF;
+    if (depth >= ASPIRATION_MIN_DEPTH && std::abs(previousScore) < MATE_BOUND) {
+        alpha = std::max(-INF, previousScore - delta);
+        beta = std::min(INF, previousScore + delta);
+    }
+
+    for (;;) {
+        if (!searchRoot(ctx, side, depth, alpha, beta, moves, bestMove, bestScore)) {
+            return false;
+        }
+
+        if (bestScore <= alpha && alpha > -INF) {
+            // Fail low: every move is worse than hoped, nothing is known about which
+            // is best. Open downwards and pull beta in a little.
+            beta = (alpha + beta) / 2;
+            alpha = std::max(-INF, bestScore - delta);
+        } else if (bestScore >= beta && beta < INF) {
+            // Fail high: the refuting move goes first in the re-search
+            beta = std::min(INF, bestScore + delta);
+            auto bestIt = std::find(moves.begin(), moves.end(), bestMove);
+            std::rotate(moves.begin(), bestIt, bestIt + 1);
+        } else {
+            return true;
+        }
+        // Doubling the window each time bounds the number of re-searches
+        delta *= 2;
+        if (delta > 1000) {
+            alpha = -INF;
+            beta = INF;
+        }
+    }
+}
+
+void Ai::helperSearch(SearchContext& ctx, SIDE side, MoveList moves, int maxDepth) {
+    // Keep the likely best move first, rotate the rest by the helper's index
+    if (moves.size() > 2) {
+        const int shift = static_cast<int>(ctx.index % (moves.size() - 1));
+        std::rotate(moves.begin() + 1, moves.begin() + 1 + shift, moves.end());
+    }
+
+    // Odd helpers run one ply ahead of the main thread, even ones alongside it.
+    // A helper that fell behind skips straight to the main thread's depth.
+    const int offset = static_cast<int>(ctx.index & 1);
+    int previousScore = 0;
+    int depth = mainDepth.load(std::memory_order_relaxed) + offset;
+    while (depth <= maxDepth) {
+        Move iterationMove{};
+        int iterationScore = 0;
+        if (!aspirationSearch(ctx, side, depth, previousScore, moves, iterationMove, iterationScore)) {
+            return;
+        }
+        previousScore = iterationScore;
+        auto bestIt = std::find(moves.begin(), moves.end(), iterationMove);
+        std::rotate(moves.begin(), bestIt, bestIt + 1);
+
+        depth = std::max(depth + 1, mainDepth.load(std::memory_order_relaxed) + offset);
+    }
+}
+
+std::optional<Ai::Move> Ai::expectedReply(const Core& rootBoard, const Move& best) const {
+    Core board = rootBoard;
+    (void)board.makeMove(best);
+    TranspositionTable::ProbeResult entry{};
+    if (!tt.probe(board.hash(), entry) || !entry.hasMove) {
+        return std::nullopt;
+    }
+    // The entry may come from a colliding position
+    MoveList replies;
+    board.generateLegalMoves(board.sideToMove(), replies);
+    if (std::find(replies.begin(), replies.end(), entry.move) == replies.end()) {
+        return std::nullopt;
+    }
+    return entry.move;
+}
+
+std::optional<Ai::Move> Ai::findBestMove(Position root) {
+    return findBestMove(root, limits);
+}
+
+std::optional<Ai::Move> Ai::findBestMove(Position root, const SearchLimits& searchLimits) {
+    const auto start = std::chrono::steady_clock::now();
+    auto elapsedMs = [&start]() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    // Private board built from the snapshot, copied once more into every thread context
+    const Core rootBoard(root);
+    const SIDE sideToMove = root.sideToMove;
+
+    MoveList moves;
     generateAllMovesInto(rootBoard, sideToMove, moves);
 
-    if (moves.empty()) return std::nullopt;
+    ponderReply.reset();
+    stats = SearchStats{};
+    // Nothing to search: the root is already mated or stalemated
+    if (moves.empty()) {
+        stats.score = rootBoard.isKingInCheck(sideToMove) ? -MATE_SCORE : 0;
+        return std::nullopt;
+    }
 
-    int bestVal = -INF;
-    std::optional<Move> bestMove = std::nullopt;
-    const SIDE opp = (sideToMove == SIDE::WHITE_SIDE) ? SIDE::BLACK_SIDE : SIDE::WHITE_SIDE;
+    tt.newSearch();
 
-    // Root move ordering
-    std::vector<int> moveScores(moves.size());
-    for (size_t i = 0; i < moves.size(); ++i) {
-        moveScores[i] = scoreMoveForOrdering(rootBoard, moves[i]);
+    // Root move ordering, last search's choice for this position first
+    TranspositionTable::ProbeResult entry{};
+    const bool ttHit = tt.probe(rootBoard.hash(), entry) && entry.hasMove;
+    int moveScores[MoveList::CAPACITY];
+    for (uint16_t i = 0; i < moves.size(); ++i) {
+        moveScores[i] = (ttHit && moves[i] == entry.move) ? TT_MOVE_SCORE : scoreMoveForOrdering(rootBoard, moves[i]);
     }
 
     // Sort root moves by capture value
-    for (size_t i = 0; i < moves.size(); ++i) {
-        for (size_t j = i + 1; j < moves.size(); ++j) {
+    for (uint16_t i = 0; i < moves.size(); ++i) {
+        for (uint16_t j = i + 1; j < moves.size(); ++j) {
             if (moveScores[j] > moveScores[i]) {
                 std::swap(moveScores[i], moveScores[j]);
                 std::swap(moves[i], moves[j]);
@@ -185,17 +1129,135 @@ std::optional<Ai::Move> Ai::findBestMove(const Core& rootBoard, SIDE sideToMove)
         }
     }
 
-    for (const auto& m : moves) {
-        Core tmp = rootBoard;
-        if (!tmp.movePiece(m.from, m.to)) continue;
+    const TimeBudget budget = planTime(searchLimits);
+    softBudgetMs = budget.softMs;
+    hardBudgetMs = budget.hardMs;
+    fixedBudget = budget.fixed;
+    searchStart = start;
+    hasDeadline = false;
+    clockArmed = false;
+    stopped.store(false, std::memory_order_relaxed);
+    // A ponder search runs on the opponent's time, the clock waits for the hit
+    if (!ponderSearch) {
+        armClock();
+    }
 
-        int val = -negamax(tmp, maxdepth - 1, opp, -INF, INF);
+    // One private copy of the position per thread, every node works on it through
+    // make/unmake. Helpers hold on to their context, so both change together.
+    if (contexts.size() != threadCount) {
+        stopHelpers();
+        contexts = std::vector<SearchContext>(threadCount);
+        startHelpers();
+    }
+    for (unsigned i = 0; i < threadCount; ++i) {
+        contexts[i].board = rootBoard;
+        contexts[i].nodes = 0;
+        contexts[i].splits = 0;
+        contexts[i].steals = 0;
+        contexts[i].index = i;
+        contexts[i].split = nullptr;
+        contexts[i].tasks.clear();
 
-        if (val > bestVal) {
-            bestVal = val;
-            bestMove = m;
+        // Killers belong to the old tree; history keeps half its weight
+        std::fill(&contexts[i].killers[0][0], &contexts[i].killers[0][0] + MAX_PLY * 2, Move{});
+        for (int& score : std::span(&contexts[i].history[0][0][0], 2 * 64 * 64)) {
+            score /= 2;
         }
     }
 
+    const int maxDepth = std::clamp(searchLimits.depth, 1, MAX_DEPTH);
+    mainDepth.store(1, std::memory_order_relaxed);
+
+    // Wake the parked helpers, everything they read is written above
+    helperSide = sideToMove;
+    helperMoves = moves;
+    helperMaxDepth = maxDepth;
+    helpersRunning.store(threadCount - 1, std::memory_order_relaxed);
+    searchSignal.fetch_add(1, std::memory_order_release);
+    searchSignal.notify_all();
+
+    SearchContext& main = contexts[0];
+
+    // Fallback if even depth 1 runs out of time: the best ordered move
+    Move bestMove = moves[0];
+    int stableIterations = 0;
+
+    for (int depth = 1; depth <= maxDepth; ++depth) {
+        mainDepth.store(depth, std::memory_order_relaxed);
+        Move iterationMove{};
+        int iterationScore = 0;
+        if (!aspirationSearch(main, sideToMove, depth, stats.score, moves, iterationMove, iterationScore)) {
+            break;
+        }
+
+        stableIterations = (depth > 1 && iterationMove == bestMove) ? stableIterations + 1 : 0;
+        bestMove = iterationMove;
+        stats.depth = depth;
+        stats.score = iterationScore;
+
+        // Progress for whoever polls the engine; helpers' nodes are only summed at the end
+        SearchReport progress;
+        progress.searchId = runningSearchId;
+        progress.hasMove = true;
+        progress.bestMove = bestMove;
+        progress.stats = stats;
+        progress.stats.nodes = main.nodes;
+        progress.stats.elapsedMs = elapsedMs();
+        reports.publish(progress);
+
+        // Next iteration starts with this one's answer
+        auto bestIt = std::find(moves.begin(), moves.end(), bestMove);
+        std::rotate(moves.begin(), bestIt, bestIt + 1);
+
+        // A forced mate does not get any better by looking deeper
+        if (std::abs(iterationScore) >= MATE_BOUND) {
+            break;
+        }
+
+        // Ponder hit since the last check: from here on this is the real search
+        if (!clockArmed && !pondering.load(std::memory_order_acquire)) {
+            armClock();
+            if (stopped.load(std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        // Clock and increment only: a fixed movetime runs until the hard deadline
+        if (clockArmed && budget.softMs > 0 && !budget.fixed) {
+            // The next iteration costs several times this one, so stop early rather
+            // than start something that will be aborted. A move that keeps winning
+            // iteration after iteration earns less time.
+            const int64_t target = stableIterations >= 3 ? budget.softMs / 3
+                : stableIterations >= 1 ? budget.softMs / 2 : budget.softMs;
+            if (elapsedMs() * 2 >= target) {
+                break;
+            }
+        }
+    }
+
+    // Helpers only ever help the main thread, its answer is the one reported.
+    // Split-point workers leave their loop on the same flag.
+    stopped.store(true, std::memory_order_relaxed);
+    for (unsigned running = helpersRunning.load(std::memory_order_acquire); running != 0;
+         running = helpersRunning.load(std::memory_order_acquire)) {
+        helpersRunning.wait(running, std::memory_order_acquire);
+    }
+
+    // Out of depth while still pondering: the answer is ready, but may only go out
+    // once the opponent has moved (hit) or the guess turned out wrong (stop)
+    while (!clockArmed && pondering.load(std::memory_order_acquire)
+           && !stopRequested.load(std::memory_order_relaxed)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    ponderReply = expectedReply(rootBoard, bestMove);
+
+    for (const auto& ctx : contexts) {
+        stats.nodes += ctx.nodes;
+        stats.splits += ctx.splits;
+        stats.steals += ctx.steals;
+    }
+    stats.hashfull = tt.hashfull();
+    stats.elapsedMs = elapsedMs();
     return bestMove;
 }
\ No newline at end of file
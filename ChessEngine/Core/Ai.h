@@ -1,43 +1,367 @@
 #pragma once
 
 #include "Core.h"
+#include "Mailbox.h"
+#include "SpscQueue.h"
+#include "TranspositionTable.h"
+#include "WorkStealingQueue.h"
 #include "definition.h"
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
 #include <optional>
-#include <future>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 // Create a new thread for the IA 
 class Ai {
 
 public:
 	Ai(Core* corePtr);
+	// Stops a background search still running and shuts the engine and helper
+	// threads down
+	~Ai();
 	
-	struct Move {
-		Vec2 from;
-		Vec2 to;
+	using Move = ::Move;
+
+	// What bounds a search. Zero means "not set"; with no time given the search
+	// runs to `depth`. movetime wins over the clock when both are set.
+	struct SearchLimits {
+		int depth = MAX_DEPTH;
+		int64_t movetimeMs = 0;   // fixed time for this move
+		int64_t timeLeftMs = 0;   // remaining clock of the side to move
+		int64_t incrementMs = 0;
+		int movesToGo = 0;        // moves until the next time control, 0 = sudden death
+	};
+
+	struct SearchStats {
+		int depth = 0;            // last fully completed iteration
+		int score = 0;            // from the side to move's point of view
+		uint64_t nodes = 0;
+		int64_t elapsedMs = 0;
+		uint64_t splits = 0;      // split points opened (split-point mode only)
+		uint64_t steals = 0;      // split tasks taken by a thread other than the owner
+		int hashfull = 0;         // transposition table entries written by this search, per mille
+	};
+
+	static constexpr int MAX_DEPTH = 64;
+	// Deepest ply a search line may reach, quiescence included
+	static constexpr int MAX_PLY = 128;
+
+	// Iterative deepening from `root` for its side to move, under `limits`. Always
+	// answers with the best move of the last completed iteration, nullopt only when
+	// there is no legal move.
+	std::optional<Move> findBestMove(Position root);
+	std::optional<Move> findBestMove(Position root, const SearchLimits& searchLimits);
+
+	// Limits used by go() and the one argument findBestMove
+	void setLimits(const SearchLimits& searchLimits) { limits = searchLimits; }
+	[[nodiscard]] const SearchLimits& getLimits() const { return limits; }
+	[[nodiscard]] const SearchStats& lastSearch() const { return stats; }
+
+	// How extra threads are put to work
+	enum class ParallelMode : uint8_t {
+		// Helpers search the same root on their own and only share the transposition table
+		LazySmp,
+		// Young Brothers Wait: once the first move of a node is searched, its siblings
+		// are offered to idle threads through work-stealing deques
+		SplitPoint
 	};
 
-	std::optional<Move> findBestMove(const Core& rootBoard, SIDE sideToMove);
+	// The setters below configure the synchronous findBestMove. They touch state the
+	// engine thread searches with, so once go() has been used they may only be
+	// called while it is not thinking; setOption() is the way to change threads,
+	// hash or mode around background searches.
+
+	// 1 means a plain single-threaded search, whatever the mode
+	void setThreads(unsigned count) { assert(!thinking); threadCount = count > 0 ? count : 1; }
+	[[nodiscard]] unsigned getThreads() const { return threadCount; }
+	void setParallelMode(ParallelMode mode) { assert(!thinking); parallelMode = mode; }
+	[[nodiscard]] ParallelMode getParallelMode() const { return parallelMode; }
+
+	// Selective pruning switches, all on by default. Off only to measure what each
+	// one saves on a fixed suite; the best move may change, never its legality.
+	struct PruningOptions {
+		bool nullMove = true;
+		bool reverseFutility = true;   // static null move near the leaves
+		bool futility = true;          // quiet moves that cannot reach alpha
+		bool razoring = true;          // drop into quiescence far below alpha
+	};
+
+	void setPruning(const PruningOptions& options) { assert(!thinking); pruning = options; }
+	[[nodiscard]] const PruningOptions& getPruning() const { return pruning; }
+
+	// Transposition table size, clears every stored result
+	void setHashSize(size_t megabytes) { assert(!thinking); tt.resize(megabytes); }
+	// Actual size, the request rounded down to a power of two of buckets
+	[[nodiscard]] size_t getHashSize() const { return tt.sizeMegabytes(); }
+	void clearHash() { assert(!thinking); tt.clear(); }
 	
-	std::future<std::optional<Move>> aiFuture;
-	bool aiThinking = false;
+	// Background engine. A thread owned by the Ai, started on the first command and
+	// kept for its whole life, takes commands through a lock-free queue and answers
+	// through a mailbox, so nothing is spawned per move and the search state
+	// (history, hash, thread contexts) stays warm between moves. Every call below
+	// belongs to one thread, the UI's; the synchronous findBestMove must not be
+	// used while the engine thread is searching.
+
+	enum class EngineOption : uint8_t {
+		Threads,
+		HashMegabytes,
+		ParallelMode      // value is a ParallelMode
+	};
+
+	// Published after every completed iteration, then once more when the search ends
+	struct SearchReport {
+		uint32_t searchId = 0;    // which go() this answers
+		bool finished = false;    // false for progress reports
+		bool hasMove = false;     // no legal move when finished without one
+		Move bestMove{};
+		bool hasPonderMove = false;
+		Move ponderMove{};        // reply expected to bestMove, finished reports only
+		SearchStats stats;        // nodes are the main thread's only until finished
+	};
+
+	// Each returns false when the command queue is full and nothing was sent
+	bool setPosition(Position root);
+	// Searches the last position sent, under the current limits or the given ones
+	bool go();
+	bool go(const SearchLimits& searchLimits);
+	// Pondering: searches `root`, the position after the reply the engine expects,
+	// on the opponent's time. No clock runs and no answer comes until ponderHit()
+	// or stop(); `limits` are those of the real search that follows a hit.
+	bool ponder(Position root);
+	// The expected reply was played: the ponder search carries on as the real one,
+	// its clock starting now, without a restart
+	void ponderHit();
+	// A ponder() has been neither hit nor answered yet. A miss is a plain stop().
+	[[nodiscard]] bool isPondering() const { return thinking && pondering.load(std::memory_order_relaxed); }
+
+	// Applied between searches, never under a running one
+	bool setOption(EngineOption option, int64_t value);
+
+	// Makes the running search return now with the best move of its last completed
+	// iteration, waits for that answer (a millisecond or two) and hands it back.
+	// nullopt when nothing was running or there was no legal move.
+	std::optional<Move> stop();
+
+	// Newest report of the current search, if one came in since the last call.
+	// Answers to searches that were stopped or superseded are dropped.
+	bool pollReport(SearchReport& report);
+	// A go() has not been answered by a finished report yet
+	[[nodiscard]] bool isThinking() const { return thinking; }
 
 private:
 	Core* core;
 
-	uint8_t maxdepth = 6;
+	// Default keeps a move under a second however sharp the position
+	SearchLimits limits{ MAX_DEPTH, 1000 };
+	SearchStats stats;
+	PruningOptions pruning;
+
+	// A node whose remaining siblings are searched by several threads at once. Lives
+	// on the owner's stack until every task handed out for it has come back.
+	struct SplitPoint {
+		Core board;                       // position at the node, helpers start from a copy
+		const MoveList* moves = nullptr;  // owner's list, untouched while split
+		const int* moveScores = nullptr;  // ordering scores, parallel to moves
+		bool inCheck = false;
+		bool futile = false;              // quiet moves are skipped once the node has a score
+		const SplitPoint* parent = nullptr;
+		SIDE side = SIDE::WHITE_SIDE;
+		int depth = 0;
+		int ply = 0;
+		int beta = 0;
+
+		std::atomic<int> nextMove{ 0 };   // next sibling index to hand out
+		std::atomic<int> pending{ 0 };    // tasks pushed and not yet finished or reclaimed
+		std::atomic<bool> cutoff{ false };
+		std::atomic<int> alpha{ 0 };      // read freely, written under mutex
+		std::atomic<int> best{ 0 };       // read freely, written under mutex
+
+		// Quiet moves searched without a cutoff, owner's stack array. Each thread
+		// claims its slot through the counter.
+		Move* quietsTried = nullptr;
+		std::atomic<int> quietCount{ 0 };
+
+		std::mutex mutex;                 // guards alpha and best updates, and bestIndex
+		int bestIndex = 0;
+	};
+
+	// Everything a search thread touches on its own: its copy of the position,
+	// counters and split-point deque. Cache line aligned so neighbouring threads
+	// never false-share.
+	struct alignas(64) SearchContext {
+		Core board;
+		uint64_t nodes = 0;
+		uint64_t splits = 0;
+		uint64_t steals = 0;
+		unsigned index = 0;               // 0 is the main thread, the only one reading the clock
+		SplitPoint* split = nullptr;      // innermost split point this thread works under
+		WorkStealingQueue<SplitPoint*> tasks;
+
+		// Quiet move ordering: two killer moves per ply, and butterfly history
+		// [side][from][to] that stays warm from one search to the next
+		Move killers[MAX_PLY][2]{};
+		int history[2][64][64]{};
+	};
+
+	struct EngineCommand {
+		enum class Type : uint8_t { Position, Go, Stop, SetOption, Quit };
+
+		Type type = Type::Stop;
+		Position position{};        // Position
+		SearchLimits limits;        // Go
+		uint32_t searchId = 0;
+		bool ponder = false;
+		EngineOption option = EngineOption::Threads;  // SetOption
+		int64_t value = 0;
+	};
+
+	static constexpr size_t COMMAND_QUEUE_SIZE = 16;
+
+	// UI thread side
+	std::thread engineThread;
+	SpscQueue<EngineCommand, COMMAND_QUEUE_SIZE> commands;
+	// Bumped after every push, the idle engine thread sleeps on it
+	std::atomic<uint32_t> commandSignal{ 0 };
+	Mailbox<SearchReport> reports;
+	uint32_t lastSearchId = 0;
+	bool thinking = false;
+
+	// Engine thread side
+	Position enginePosition{};
+	uint32_t runningSearchId = 0;
+	bool ponderSearch = false;                // the running Go was a ponder()
+	std::optional<Move> ponderReply;          // expected reply found by the last search
+
+	bool post(const EngineCommand& command);
+	bool postGo(const SearchLimits& searchLimits, bool ponder);
+	void engineLoop();
+
+	// Below this depth a split costs more than it saves
+	static constexpr int MIN_SPLIT_DEPTH = 3;
+
+	// The main thread reads the clock every TIME_CHECK_INTERVAL nodes; a passed
+	// deadline, or the main thread finishing, unwinds every tree through `stopped`.
+	static constexpr uint64_t TIME_CHECK_INTERVAL = 2048;
+	std::atomic<bool> stopped{ false };
+	// Raised by stop() from the UI thread, picked up on the same clock check and
+	// lowered by the engine thread on the Stop command that follows. Kept apart from
+	// `stopped` so a search starting late cannot clear it.
+	std::atomic<bool> stopRequested{ false };
+	// Iteration the main thread is on; Lazy SMP helpers pick their next depth from it
+	std::atomic<int> mainDepth{ 1 };
+	bool hasDeadline = false;
+	std::chrono::steady_clock::time_point deadline;
+
+	// Raised by ponder() and lowered by ponderHit(), both on the UI thread. A ponder
+	// search keeps its clock unarmed until it sees the flag down.
+	std::atomic<bool> pondering{ false };
+	bool clockArmed = false;
+	int64_t softBudgetMs = 0;
+	int64_t hardBudgetMs = 0;
+	bool fixedBudget = false;         // movetime rather than clock and increment
+	std::chrono::steady_clock::time_point searchStart;
+	// Main thread only, at the start or on a ponder hit. Time spent pondering counts
+	// toward the budget: a fixed movetime ends where it would have without the
+	// ponder, a clock budget gets its hard limit from now but stops at once past
+	// the soft one.
+	void armClock();
+
+	unsigned threadCount = 1;
+	ParallelMode parallelMode = ParallelMode::LazySmp;
+	std::vector<SearchContext> contexts;
+
+	// Helper threads, one per context but the main thread's. Started with the first
+	// search that needs them, restarted only when the thread count changes, and
+	// parked on searchSignal in between like the engine thread on commandSignal.
+	std::vector<std::thread> helperThreads;
+	// Bumped by the searching thread to start the helpers on a search, or to quit
+	std::atomic<uint32_t> searchSignal{ 0 };
+	// Helpers still busy with the current search, the searching thread waits on it
+	std::atomic<unsigned> helpersRunning{ 0 };
+	// Written before a bump of searchSignal, read by the helpers after it
+	bool helpersQuit = false;
+	SIDE helperSide = SIDE::WHITE_SIDE;       // Lazy SMP root
+	MoveList helperMoves;
+	int helperMaxDepth = 1;
+
+	// Sized to threadCount, helpers parked
+	void startHelpers();
+	void stopHelpers();
+	void helperLoop(unsigned index, uint32_t seen);
+
+	TranspositionTable tt;
 
 	// helpers
-	std::vector<Move> generateAllMoves(const Core& board, SIDE side) const;
+	MoveList generateAllMoves(const Core& board, SIDE side) const;
 
-	void generateAllMovesInto(const Core &board, SIDE side, std::vector<Move> &moves) const;
+	void generateAllMovesInto(const Core &board, SIDE side, MoveList &moves) const;
 
 	int evaluate(const Core& board) const;
 
 	int scoreMoveForOrdering(const Core &board, const Move &m) const;
 
+	// Neither a capture, en passant nor a promotion
+	static bool isQuiet(const Core& board, const Move& m);
+
+	static void updateHistory(int& entry, int bonus);
+
 	int pieceValue(PIECE p) const;
 
-	// negamax with alpha-beta
-	int negamax(Core board, int depth, SIDE side, int alpha, int beta) const;
+	// negamax with alpha-beta, on the context's position mutated through make/unmake.
+	// ply is the distance from the root, used for mate scores.
+	// allowNull is false right after a null move, and in the verification search.
+	int negamax(SearchContext& ctx, int depth, int ply, SIDE side, int alpha, int beta, bool allowNull = true);
+
+	// Side has something besides king and pawns, zugzwang is then unlikely
+	static bool hasNonPawnMaterial(const Core& board, SIDE side);
+
+	// Plays one child of a negamax node and returns its score: PVS zero-window
+	// scout for every move but the first, late move reductions with re-search
+	int searchMove(SearchContext& ctx, const Move& m, int moveIndex, int moveScore, bool quiet, bool inCheck,
+	               int depth, int ply, SIDE side, int alpha, int beta);
+
+	// Captures (all evasions when in check) until the position is quiet, so the
+	// horizon never lands in the middle of an exchange
+	int quiescence(SearchContext& ctx, int ply, SIDE side, int alpha, int beta);
+
+	// One pass over the ordered root moves within (alpha, beta), principal variation
+	// style. False when the search was stopped.
+	bool searchRoot(SearchContext& ctx, SIDE side, int depth, int alpha, int beta,
+	                MoveList& moves, Move& bestMove, int& bestScore);
+
+	// One iteration: searchRoot in a narrow window around the previous score,
+	// widened and repeated on fail low/high until the score falls inside
+	bool aspirationSearch(SearchContext& ctx, SIDE side, int depth, int previousScore,
+	                      MoveList& moves, Move& bestMove, int& bestScore);
+
+	// Lazy SMP helper: its own iterative deepening, kept on or one past the main
+	// thread's depth and with a shifted root order so threads spread over
+	// different subtrees
+	void helperSearch(SearchContext& ctx, SIDE side, MoveList moves, int maxDepth);
+
+	// Split-point mode: searches the siblings from `first` on together with whoever
+	// steals the tasks, then folds the result back into alpha/best/bestIndex and
+	// the quiet moves tried into quietsTried/quietCount. False when the node was
+	// aborted.
+	bool splitSearch(SearchContext& ctx, const MoveList& moves, const int* moveScores, bool inCheck, bool futile,
+	                 int first, int depth, int ply, SIDE side, int& alpha, int beta, int& best, int& bestIndex,
+	                 Move* quietsTried, int& quietCount);
+	// Takes sibling indices off the split point until none is left or it is cut off
+	void searchSplitMoves(SearchContext& ctx, SplitPoint& sp);
+	// Split-point helper: steals tasks from the other threads until the search ends
+	void workerLoop(SearchContext& ctx);
+
+	// Stop requested, or a split point this thread is working under failed high
+	[[nodiscard]] bool aborted(const SearchContext& ctx) const;
+
+	// Main thread only: raises `stopped` once the deadline passes or stop() asks,
+	// and arms the clock of a ponder search that was hit
+	void checkTime();
+
+	// Hash move of the position `best` leads to, if it is legal there
+	std::optional<Move> expectedReply(const Core& rootBoard, const Move& best) const;
 };
\ No newline at end of file
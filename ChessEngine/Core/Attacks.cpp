@@ -0,0 +1,245 @@
+#include "Attacks.h"
+
+#if defined(_MSC_VER) && defined(CHESS_ATTACKS_HAS_PEXT)
+#include <intrin.h>
+#endif
+
+namespace Attacks::detail {
+    Magic rookMagics[64];
+    Magic bishopMagics[64];
+    Bitboard knightAttacks[64];
+    Bitboard kingAttacks[64];
+    Bitboard pawnAttacks[2][64];
+    Bitboard betweenSquares[64][64];
+    bool usePext = false;
+}
+
+namespace
+{
+    using namespace Attacks;
+
+    // Exact table sizes: sum over squares of 2^(relevant occupancy bits)
+    Bitboard rookTable[0x19000];
+    Bitboard bishopTable[0x1480];
+
+    constexpr int ROOK_DIRECTIONS[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 } };
+    constexpr int BISHOP_DIRECTIONS[4][2] = { { 1, 1 }, { 1, -1 }, { -1, 1 }, { -1, -1 } };
+
+    bool onBoard(int x, int y)
+    {
+        return x >= 0 && x < 8 && y >= 0 && y < 8;
+    }
+
+    // Reference ray walk, only used while building the tables
+    Bitboard slidingAttacks(uint8_t square, Bitboard occupied, const int (&directions)[4][2])
+    {
+        Bitboard attacks = EMPTY_BB;
+        const Vec2 origin = toVec2(square);
+        for (const auto& dir : directions) {
+            int x = origin.x + dir[0];
+            int y = origin.y + dir[1];
+            while (onBoard(x, y)) {
+                const Bitboard bit = squareBB(static_cast<uint8_t>(y * 8 + x));
+                attacks |= bit;
+                if (occupied & bit) {
+                    break;
+                }
+                x += dir[0];
+                y += dir[1];
+            }
+        }
+        return attacks;
+    }
+
+    // Rays without their last square: a blocker on the edge never hides anything
+    Bitboard relevantMask(uint8_t square, const int (&directions)[4][2])
+    {
+        Bitboard mask = EMPTY_BB;
+        const Vec2 origin = toVec2(square);
+        for (const auto& dir : directions) {
+            int x = origin.x + dir[0];
+            int y = origin.y + dir[1];
+            while (onBoard(x + dir[0], y + dir[1])) {
+                mask |= squareBB(static_cast<uint8_t>(y * 8 + x));
+                x += dir[0];
+                y += dir[1];
+            }
+        }
+        return mask;
+    }
+
+    // xorshift64*, deterministic so magic search always lands on the same numbers
+    struct Prng {
+        uint64_t state;
+
+        uint64_t next()
+        {
+            state ^= state >> 12;
+            state ^= state << 25;
+            state ^= state >> 27;
+            return state * 2685821657736338717ULL;
+        }
+
+        // Few set bits make good magic candidates
+        uint64_t sparse() { return next() & next() & next(); }
+    };
+
+    bool cpuHasBmi2()
+    {
+#if defined(CHESS_ATTACKS_HAS_PEXT)
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 8)) != 0;
+#else
+        return __builtin_cpu_supports("bmi2");
+#endif
+#else
+        return false;
+#endif
+    }
+
+    void initSliders(Magic (&magics)[64], Bitboard* table, const int (&directions)[4][2])
+    {
+        Bitboard occupancies[4096];
+        Bitboard references[4096];
+        int epoch[4096] = {};
+        int attempt = 0;
+
+        // Per-row seeds known to converge quickly for this mask layout
+        constexpr uint64_t seeds[8] = { 728, 10316, 55013, 32803, 12281, 15100, 16645, 255 };
+
+        Bitboard* slice = table;
+        for (uint8_t square = 0; square < 64; ++square) {
+            Magic& m = magics[square];
+            m.mask = relevantMask(square, directions);
+            const int bits = popCount(m.mask);
+            m.shift = static_cast<uint8_t>(64 - bits);
+            m.attacks = slice;
+
+            // Carry-Rippler walk over every subset of the mask
+            int size = 0;
+            Bitboard subset = EMPTY_BB;
+            do {
+                occupancies[size] = subset;
+                references[size] = slidingAttacks(square, subset, directions);
+                ++size;
+                subset = (subset - m.mask) & m.mask;
+            } while (subset);
+
+            slice += size;
+
+            if (detail::usePext) {
+                m.magic = 0;
+                for (int i = 0; i < size; ++i) {
+                    m.attacks[detail::pext(occupancies[i], m.mask)] = references[i];
+                }
+                continue;
+            }
+
+            // Trial and error until a candidate maps every subset without destructive collisions
+            Prng prng{ seeds[square >> 3] };
+            for (int i = 0; i < size;) {
+                do {
+                    m.magic = prng.sparse();
+                } while (popCount((m.magic * m.mask) >> 56) < 6);
+
+                ++attempt;
+                for (i = 0; i < size; ++i) {
+                    const size_t idx = detail::index(m, occupancies[i]);
+                    if (epoch[idx] < attempt) {
+                        epoch[idx] = attempt;
+                        m.attacks[idx] = references[i];
+                    }
+                    else if (m.attacks[idx] != references[i]) {
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    void initLeapers()
+    {
+        constexpr int knightOffsets[8][2] = {
+            { 1, 2 },{ 2, 1 },{ 2, -1 },{ 1, -2 },
+            { -1, -2 },{ -2, -1 },{ -2, 1 },{ -1, 2 }
+        };
+
+        for (uint8_t square = 0; square < 64; ++square) {
+            const Vec2 origin = toVec2(square);
+            auto bitAt = [&](int dx, int dy) -> Bitboard {
+                const int x = origin.x + dx;
+                const int y = origin.y + dy;
+                return onBoard(x, y) ? squareBB(static_cast<uint8_t>(y * 8 + x)) : EMPTY_BB;
+            };
+
+            Bitboard knight = EMPTY_BB;
+            for (const auto& offset : knightOffsets) {
+                knight |= bitAt(offset[0], offset[1]);
+            }
+            detail::knightAttacks[square] = knight;
+
+            Bitboard king = EMPTY_BB;
+            for (int dx = -1; dx <= 1; ++dx) {
+                for (int dy = -1; dy <= 1; ++dy) {
+                    if (dx != 0 || dy != 0) {
+                        king |= bitAt(dx, dy);
+                    }
+                }
+            }
+            detail::kingAttacks[square] = king;
+
+            // White pawns advance towards y == 0, black pawns towards y == 7
+            detail::pawnAttacks[static_cast<uint8_t>(SIDE::WHITE_SIDE)][square] = bitAt(-1, -1) | bitAt(1, -1);
+            detail::pawnAttacks[static_cast<uint8_t>(SIDE::BLACK_SIDE)][square] = bitAt(-1, 1) | bitAt(1, 1);
+        }
+    }
+
+    void initBetween()
+    {
+        for (uint8_t a = 0; a < 64; ++a) {
+            for (uint8_t b = 0; b < 64; ++b) {
+                const Vec2 from = toVec2(a);
+                const Vec2 to = toVec2(b);
+                const int dX = static_cast<int>(to.x) - static_cast<int>(from.x);
+                const int dY = static_cast<int>(to.y) - static_cast<int>(from.y);
+
+                Bitboard squares = EMPTY_BB;
+                if (a != b && (dX == 0 || dY == 0 || dX == dY || dX == -dY)) {
+                    const int stepX = (dX > 0) - (dX < 0);
+                    const int stepY = (dY > 0) - (dY < 0);
+                    int x = from.x + stepX;
+                    int y = from.y + stepY;
+                    while (x != to.x || y != to.y) {
+                        squares |= squareBB(static_cast<uint8_t>(y * 8 + x));
+                        x += stepX;
+                        y += stepY;
+                    }
+                }
+                detail::betweenSquares[a][b] = squares;
+            }
+        }
+    }
+
+    void build()
+    {
+        detail::usePext = cpuHasBmi2();
+        initSliders(detail::rookMagics, rookTable, ROOK_DIRECTIONS);
+        initSliders(detail::bishopMagics, bishopTable, BISHOP_DIRECTIONS);
+        initLeapers();
+        initBetween();
+    }
+}
+
+void Attacks::init()
+{
+    // Function-local static: built exactly once, even with several Core instances on several threads
+    static const bool initialized = (build(), true);
+    (void)initialized;
+}
+
+bool Attacks::usingPext()
+{
+    return detail::usePext;
+}
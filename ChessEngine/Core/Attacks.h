@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "definition.h"
+#include "Bitboard.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CHESS_ATTACKS_HAS_PEXT 1
+#include <immintrin.h>
+#endif
+
+// Precomputed attack tables. Sliders use fancy magic bitboards, or PEXT when the
+// CPU reports BMI2 at runtime; both share the same table layout so only the index
+// computation differs. Attacks::init() must run once before any lookup, Core's
+// constructor takes care of it.
+namespace Attacks {
+
+	struct Magic {
+		Bitboard mask;      // relevant occupancy, board edges excluded
+		Bitboard magic;
+		Bitboard* attacks;  // slice of the shared attack table for this square
+		uint8_t shift;
+	};
+
+	void init();
+	[[nodiscard]] bool usingPext();
+
+	namespace detail {
+		extern Magic rookMagics[64];
+		extern Magic bishopMagics[64];
+		extern Bitboard knightAttacks[64];
+		extern Bitboard kingAttacks[64];
+		extern Bitboard pawnAttacks[2][64];
+		extern Bitboard betweenSquares[64][64];
+		extern bool usePext;
+
+#ifdef CHESS_ATTACKS_HAS_PEXT
+#if defined(__GNUC__) || defined(__clang__)
+		__attribute__((target("bmi2")))
+#endif
+		inline uint64_t pext(Bitboard occupied, Bitboard mask) {
+			return _pext_u64(occupied, mask);
+		}
+#endif
+
+		[[nodiscard]] inline size_t index(const Magic& m, Bitboard occupied) {
+#ifdef CHESS_ATTACKS_HAS_PEXT
+			if (usePext) {
+				return static_cast<size_t>(pext(occupied, m.mask));
+			}
+#endif
+			return static_cast<size_t>(((occupied & m.mask) * m.magic) >> m.shift);
+		}
+	}
+
+	[[nodiscard]] inline Bitboard rook(uint8_t square, Bitboard occupied) {
+		const Magic& m = detail::rookMagics[square];
+		return m.attacks[detail::index(m, occupied)];
+	}
+
+	[[nodiscard]] inline Bitboard bishop(uint8_t square, Bitboard occupied) {
+		const Magic& m = detail::bishopMagics[square];
+		return m.attacks[detail::index(m, occupied)];
+	}
+
+	[[nodiscard]] inline Bitboard queen(uint8_t square, Bitboard occupied) {
+		return rook(square, occupied) | bishop(square, occupied);
+	}
+
+	[[nodiscard]] inline Bitboard knight(uint8_t square) { return detail::knightAttacks[square]; }
+	[[nodiscard]] inline Bitboard king(uint8_t square) { return detail::kingAttacks[square]; }
+
+	// Squares attacked by a pawn of `side` standing on `square`
+	[[nodiscard]] inline Bitboard pawn(SIDE side, uint8_t square) {
+		return detail::pawnAttacks[static_cast<uint8_t>(side)][square];
+	}
+
+	// Squares strictly between a and b when they share a rank, file or diagonal, empty otherwise
+	[[nodiscard]] inline Bitboard between(uint8_t a, uint8_t b) { return detail::betweenSquares[a][b]; }
+}
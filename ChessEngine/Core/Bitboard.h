@@ -0,0 +1,44 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+
+#include "definition.h"
+
+// 64-bit square sets. Bit n maps to chessBoard[n], i.e. square index y * 8 + x,
+// so bit 0 is a8 (black's back rank) and bit 63 is h1.
+using Bitboard = uint64_t;
+
+constexpr Bitboard EMPTY_BB = 0ULL;
+
+[[nodiscard]] constexpr uint8_t toSquare(const Vec2& pos) noexcept {
+	return static_cast<uint8_t>(pos.y * 8 + pos.x);
+}
+
+[[nodiscard]] constexpr Vec2 toVec2(uint8_t square) noexcept {
+	return Vec2{ static_cast<uint8_t>(square & 7), static_cast<uint8_t>(square >> 3) };
+}
+
+[[nodiscard]] constexpr Bitboard squareBB(uint8_t square) noexcept {
+	return 1ULL << square;
+}
+
+[[nodiscard]] constexpr Bitboard squareBB(const Vec2& pos) noexcept {
+	return squareBB(toSquare(pos));
+}
+
+[[nodiscard]] constexpr int popCount(Bitboard bb) noexcept {
+	return std::popcount(bb);
+}
+
+// Index of the least significant set bit, bb must not be empty
+[[nodiscard]] constexpr uint8_t lsb(Bitboard bb) noexcept {
+	return static_cast<uint8_t>(std::countr_zero(bb));
+}
+
+// Pops and returns the least significant set bit, bb must not be empty
+constexpr uint8_t popLsb(Bitboard& bb) noexcept {
+	const uint8_t square = lsb(bb);
+	bb &= bb - 1;
+	return square;
+}
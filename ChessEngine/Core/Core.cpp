@@ -1,5 +1,8 @@
 #include "Core.h"
+#include "Attacks.h"
+#include "Zobrist.h"
 
+#include <cassert>
 #include <iostream>
 #include <cstdlib>
 #include <algorithm>
@@ -9,51 +12,121 @@
 
 Core::Core()
 {
+    Attacks::init();
     fillChessBoard();
     setupCache();
 }
 
+Core::Core(const Position& position)
+{
+    Attacks::init();
+    load(position);
+}
 
-// if the cell is filled push it to cache 
-void Core::setupCache() {
-    filledCell.clear();
-    filledCell.reserve(32);
-    for (size_t y = 0; y < 8; ++y) {
-        for (size_t x = 0; x < 8; ++x) {
-            size_t index = y * 8 + x;
-            if (chessBoard[index].fill == 1) {
-                filledCell.push_back(Vec2{ static_cast<uint8_t>(x), static_cast<uint8_t>(y) });
-            }
-        }
-    }
+Position Core::snapshot() const
+{
+    Position position;
+    std::copy(std::begin(chessBoard), std::end(chessBoard), position.board);
+    position.hash = hashKey;
+    position.halfmoveClock = halfmoveClock;
+    position.fullmoveNumber = fullmoveNumber;
+    position.castlingState = packCastlingState();
+    position.enPassantSquare = enPassantActive ? toSquare(enPassantTarget) : Position::NO_EN_PASSANT;
+    position.sideToMove = activeSide;
+    return position;
 }
 
-void Core::removeFromCache(const Vec2& pos)
+void Core::load(const Position& position)
 {
-    auto it = std::remove(filledCell.begin(), filledCell.end(), pos);
-    if (it != filledCell.end()) {
-        filledCell.erase(it, filledCell.end());
+    std::copy(std::begin(position.board), std::end(position.board), chessBoard);
+    halfmoveClock = position.halfmoveClock;
+    fullmoveNumber = position.fullmoveNumber;
+    restoreCastlingState(position.castlingState);
+    activeSide = position.sideToMove;
+
+    enPassantActive = position.enPassantSquare != Position::NO_EN_PASSANT;
+    if (enPassantActive) {
+        // The pawn that pushed two stands one rank past the target, seen from its side
+        enPassantTarget = { static_cast<uint8_t>(position.enPassantSquare % 8), static_cast<uint8_t>(position.enPassantSquare / 8) };
+        enPassantCapturedPawn = { enPassantTarget.x,
+            static_cast<uint8_t>(activeSide == SIDE::WHITE_SIDE ? enPassantTarget.y + 1 : enPassantTarget.y - 1) };
     }
+
+    setupCache();
+    assert(hashKey == position.hash);
 }
 
-void Core::updateCache(const Vec2& from,
-    const Vec2& to,
-    bool capturedDestination,
-    std::optional<Vec2> enPassantCaptured,
-    std::optional<std::pair<Vec2, Vec2>> rookMove)
+
+// Rebuild every derived structure from the mailbox
+void Core::setupCache()
 {
-    removeFromCache(from);
-    if (capturedDestination) {
-        removeFromCache(to);
+    std::fill(&pieceBB[0][0], &pieceBB[0][0] + 12, EMPTY_BB);
+    sideBB[0] = sideBB[1] = EMPTY_BB;
+    occupiedBB = EMPTY_BB;
+    std::fill(&pieceCount[0][0], &pieceCount[0][0] + 12, uint8_t{ 0 });
+    uint64_t key = 0;
+
+    for (uint8_t square = 0; square < 64; ++square) {
+        const BoardCell cell = chessBoard[square];
+        if (cell.fill == 1) {
+            const Bitboard bit = squareBB(square);
+            pieceBB[cell.side][cell.piece] |= bit;
+            sideBB[cell.side] |= bit;
+            occupiedBB |= bit;
+
+            uint8_t& count = pieceCount[cell.side][cell.piece];
+            pieceList[cell.side][cell.piece][count] = square;
+            pieceIndex[square] = count++;
+            if (cell.piece == static_cast<uint8_t>(PIECE::King)) {
+                kingSquare[cell.side] = square;
+            }
+            key ^= Zobrist::KEYS.pieces[cell.side][cell.piece][square];
+        }
     }
-    if (enPassantCaptured.has_value()) {
-        removeFromCache(*enPassantCaptured);
+
+    // Same terms as computeHash, folded into the single board pass
+    key ^= Zobrist::KEYS.castling[castlingRights()] ^ enPassantKey();
+    if (activeSide == SIDE::BLACK_SIDE) {
+        key ^= Zobrist::KEYS.blackToMove;
+    }
+    hashKey = key;
+}
+
+// Single write path into the mailbox: keeps the bitboards in step with chessBoard
+void Core::setCell(const Vec2& pos, BoardCell cell)
+{
+    const uint8_t square = toSquare(pos);
+    const Bitboard bit = squareBB(square);
+    const BoardCell old = chessBoard[square];
+
+    if (old.fill == 1) {
+        pieceBB[old.side][old.piece] &= ~bit;
+        sideBB[old.side] &= ~bit;
+        occupiedBB &= ~bit;
+        hashKey ^= Zobrist::KEYS.pieces[old.side][old.piece][square];
+
+        // O(1) removal: the last entry of the list takes over the freed slot
+        uint8_t* list = pieceList[old.side][old.piece];
+        const uint8_t last = list[--pieceCount[old.side][old.piece]];
+        list[pieceIndex[square]] = last;
+        pieceIndex[last] = pieceIndex[square];
     }
-    if (rookMove.has_value()) {
-        removeFromCache(rookMove->first);
-        filledCell.push_back(rookMove->second);
+
+    chessBoard[square] = cell;
+
+    if (cell.fill == 1) {
+        pieceBB[cell.side][cell.piece] |= bit;
+        sideBB[cell.side] |= bit;
+        occupiedBB |= bit;
+        hashKey ^= Zobrist::KEYS.pieces[cell.side][cell.piece][square];
+
+        uint8_t& count = pieceCount[cell.side][cell.piece];
+        pieceList[cell.side][cell.piece][count] = square;
+        pieceIndex[square] = count++;
+        if (cell.piece == static_cast<uint8_t>(PIECE::King)) {
+            kingSquare[cell.side] = square;
+        }
     }
-    filledCell.push_back(to);
 }
 
 void Core::debugDisplayChessBoard() const
@@ -68,453 +141,790 @@ void Core::debugDisplayChessBoard() const
 }
 
 
-bool Core::isMoveLegal(const Vec2& from, const Vec2& to) const
+// Fonction helper pour vérifier qu'il n'y a pas de pièce entre from et to
+bool Core::isPathClear(const Vec2& from, const Vec2& to) const
 {
+    return (Attacks::between(toSquare(from), toSquare(to)) & occupiedBB) == 0;
+}
+
+// King squares are cached, no board scan
+Vec2 Core::findKing(SIDE side) const {
+    return toVec2(kingSquare[static_cast<uint8_t>(side)]);
+}
+
+bool Core::isKingInCheck(SIDE kingSide) const {
+    SIDE opponentSide = (kingSide == SIDE::WHITE_SIDE) ? SIDE::BLACK_SIDE : SIDE::WHITE_SIDE;
+    return isSquareAttacked(kingSquare[static_cast<uint8_t>(kingSide)], opponentSide, occupiedBB);
+}
+
+bool Core::movePiece(const Vec2& from, const Vec2& to, PIECE promotion) {
     if (!isMoveInBounds(from) || !isMoveInBounds(to)) {
         return false;
     }
 
-    const auto& fromCell = At(from);
-    const auto& toCell = At(to);
-
+    const BoardCell& fromCell = At(from);
     if (fromCell.fill == 0) {
         return false;
     }
 
-    if (toCell.fill == 1 && fromCell.side == toCell.side) {
-        return false;
+    // Entry point for the UI: validate against the legal list, then play it
+    MoveList legalMoves;
+    generateLegalMoves(static_cast<SIDE>(fromCell.side), legalMoves);
+
+    for (const Move& move : legalMoves) {
+        if (move.from == from && move.to == to &&
+            (move.promotion == PIECE::King || move.promotion == promotion)) {
+            (void)makeMove(move);
+            return true;
+        }
     }
+    return false;
+}
 
-    bool legal = false;
+Core::UndoInfo Core::makeMove(const Move& move) {
+    const Vec2& from = move.from;
+    const Vec2& to = move.to;
+
+    const BoardCell moving = At(from);
+    const BoardCell captured = At(to);
+    const SIDE movingSide = static_cast<SIDE>(moving.side);
+
+    const UndoInfo undo{
+        moving,
+        captured,
+        packCastlingState(),
+        enPassantActive,
+        enPassantTarget,
+        enPassantCapturedPawn,
+        halfmoveClock
+    };
 
-    int dX = static_cast<int>(to.x) - static_cast<int>(from.x);
-    int dY = static_cast<int>(to.y) - static_cast<int>(from.y);
-     int deltaX = std::abs(dX);
-    int deltaY = std::abs(dY);
+    // Take the old rights and en-passant file out of the key before anything moves,
+    // the new ones go back in once the position is final
+    hashKey ^= Zobrist::KEYS.castling[castlingRights()] ^ enPassantKey();
 
-    const SIDE movingSide = static_cast<SIDE>(fromCell.side);
-    const SIDE opponentSide = (movingSide == SIDE::WHITE_SIDE) ? SIDE::BLACK_SIDE : SIDE::WHITE_SIDE;
+    const bool isCastlingMove = (moving.piece == static_cast<uint8_t>(PIECE::King) &&
+                                 std::abs(static_cast<int>(to.x) - static_cast<int>(from.x)) == 2);
 
-    switch (fromCell.piece) {
+    const bool isEnPassantCapture = (moving.piece == static_cast<uint8_t>(PIECE::Pion) &&
+                                     enPassantActive &&
+                                     to == enPassantTarget &&
+                                     captured.fill == 0);
 
-    case static_cast<int>(PIECE::Pion): {
-        int direction = (movingSide == SIDE::WHITE_SIDE) ? -1 : 1;
-        int startRow = (movingSide == SIDE::WHITE_SIDE) ? 6 : 1;
+    setCell(to, moving);
+    setCell(from, BoardCell{});
 
-        if (dX == 0 && dY == direction && toCell.fill == 0) {
-            legal = true;
-        }
-        else if (dX == 0 && dY == 2 * direction && from.y == startRow && toCell.fill == 0) {
-            Vec2 intermediate = { static_cast<uint8_t>(from.x), static_cast<uint8_t>(from.y + direction) };
-            if (At(intermediate).fill == 0) {
-                legal = true;
-            }
-        }
-        else if (deltaX == 1 && dY == direction && toCell.fill == 1 && toCell.side != fromCell.side) {
-            legal = true;
-        }
-        else if (deltaX == 1 && dY == direction && toCell.fill == 0 && enPassantActive) {
-            if (to.x == enPassantTarget.x && to.y == enPassantTarget.y) {
-                const BoardCell& captured = At(enPassantCapturedPawn);
-                if (captured.fill == 1 &&
-                    captured.piece == static_cast<uint8_t>(PIECE::Pion) &&
-                    captured.side != fromCell.side) {
-                    legal = true;
-                }
-            }
-        }
-        break;
+    if (isEnPassantCapture) {
+        setCell(enPassantCapturedPawn, BoardCell{});
     }
 
-    case static_cast<int>(PIECE::Rook): {
-        if (deltaX == 0 || deltaY == 0) {
-            legal = isPathClear(from, to);
-        }
-        break;
+    if (isCastlingMove) {
+        const bool kingSide = (to.x > from.x);
+        const Vec2 rookFromPos{ static_cast<uint8_t>(kingSide ? 7 : 0), from.y };
+        const Vec2 rookToPos{ static_cast<uint8_t>(kingSide ? 5 : 3), from.y };
+        setCell(rookToPos, At(rookFromPos));
+        setCell(rookFromPos, BoardCell{});
     }
 
-    case static_cast<int>(PIECE::Knight): {
-        if ((deltaX == 2 && deltaY == 1) || (deltaX == 1 && deltaY == 2)) {
-            legal = true;
+    if (moving.piece == static_cast<uint8_t>(PIECE::King)) {
+        if (movingSide == SIDE::WHITE_SIDE) {
+            whiteKingMoved = true;
+        } else {
+            blackKingMoved = true;
+        }
+        if (isCastlingMove) {
+            markRookMoved(movingSide, to.x > from.x);
         }
-        break;
     }
 
-    case static_cast<int>(PIECE::Bishop): {
-        if (deltaX == deltaY && deltaX > 0) {
-            legal = isPathClear(from, to);
+    if (moving.piece == static_cast<uint8_t>(PIECE::Rook)) {
+        if (from.y == (movingSide == SIDE::WHITE_SIDE ? 7 : 0)) {
+            if (from.x == 0) {
+                markRookMoved(movingSide, false);
+            } else if (from.x == 7) {
+                markRookMoved(movingSide, true);
+            }
         }
-        break;
     }
 
-    case static_cast<int>(PIECE::Queen): {
-        if (deltaX == 0 || deltaY == 0 || deltaX == deltaY) {
-            legal = isPathClear(from, to);
-        }
-        break;
+    if (captured.fill == 1 && captured.piece == static_cast<uint8_t>(PIECE::Rook)) {
+        handleRookCapture(to, static_cast<SIDE>(captured.side));
     }
 
-    case static_cast<int>(PIECE::King): {
-        if (deltaX <= 1 && deltaY <= 1 && (deltaX + deltaY > 0)) {
-            legal = true;
+    enPassantActive = false;
+    if (moving.piece == static_cast<uint8_t>(PIECE::Pion)) {
+        int direction = (movingSide == SIDE::WHITE_SIDE) ? -1 : 1;
+        if (static_cast<int>(to.y) - static_cast<int>(from.y) == 2 * direction) {
+            enPassantActive = true;
+            enPassantTarget = { static_cast<uint8_t>(from.x), static_cast<uint8_t>(from.y + direction) };
+            enPassantCapturedPawn = to;
         }
-        else if (deltaY == 0 && deltaX == 2) {
-            bool kingSide = (dX > 0);
-            bool kingHasMoved = (movingSide == SIDE::WHITE_SIDE) ? whiteKingMoved : blackKingMoved;
-            if (!kingHasMoved && !hasRookMoved(movingSide, kingSide)) {
-                Vec2 rookPos{ static_cast<uint8_t>(kingSide ? 7 : 0), from.y };
-                const BoardCell& rookCell = At(rookPos);
-                if (rookCell.fill == 1 &&
-                    rookCell.piece == static_cast<uint8_t>(PIECE::Rook) &&
-                    rookCell.side == fromCell.side) {
-                    if (isPathClear(from, rookPos) && At(to).fill == 0) {
-                        Vec2 stepSquare{ static_cast<uint8_t>(from.x + (kingSide ? 1 : -1)), from.y };
-                        if (!isSquareAttacked(from, opponentSide) &&
-                            !isSquareAttacked(stepSquare, opponentSide) &&
-                            !isSquareAttacked(to, opponentSide)) {
-                            legal = true;
-                        }
-                    }
-                }
-            }
+
+        if ((movingSide == SIDE::WHITE_SIDE && to.y == 0) ||
+            (movingSide == SIDE::BLACK_SIDE && to.y == 7)) {
+            const PIECE promoted = (move.promotion == PIECE::King) ? PIECE::Queen : move.promotion;
+            setCell(to, makeCell(promoted, movingSide, true));
         }
-        break;
     }
+
+    if (moving.piece == static_cast<uint8_t>(PIECE::Pion) || captured.fill == 1 || isEnPassantCapture) {
+        halfmoveClock = 0;
+    } else {
+        ++halfmoveClock;
+    }
+    if (movingSide == SIDE::BLACK_SIDE) {
+        ++fullmoveNumber;
     }
 
-    return legal;
+    activeSide = (movingSide == SIDE::WHITE_SIDE) ? SIDE::BLACK_SIDE : SIDE::WHITE_SIDE;
+    hashKey ^= Zobrist::KEYS.castling[castlingRights()] ^ enPassantKey() ^ Zobrist::KEYS.blackToMove;
+    assert(hashKey == computeHash());
+
+    return undo;
 }
 
-// Fonction helper pour vérifier qu'il n'y a pas de pièce entre from et to
-bool Core::isPathClear(const Vec2& from, const Vec2& to) const
-{
-    int stepX = (to.x > from.x) ? 1 : (to.x < from.x) ? -1 : 0;
-    int stepY = (to.y > from.y) ? 1 : (to.y < from.y) ? -1 : 0;
+void Core::unmakeMove(const Move& move, const UndoInfo& undo) {
+    const Vec2& from = move.from;
+    const Vec2& to = move.to;
+    const BoardCell moved = undo.moved;
+
+    hashKey ^= Zobrist::KEYS.castling[castlingRights()] ^ enPassantKey() ^ Zobrist::KEYS.blackToMove;
+
+    // Promotions are undone for free: `from` gets the original pawn back
+    setCell(from, moved);
+    setCell(to, undo.captured);
+
+    const bool wasEnPassantCapture = (moved.piece == static_cast<uint8_t>(PIECE::Pion) &&
+                                      undo.enPassantActive &&
+                                      to == undo.enPassantTarget &&
+                                      undo.captured.fill == 0);
+    if (wasEnPassantCapture) {
+        const SIDE capturedSide = (moved.side == static_cast<uint8_t>(SIDE::WHITE_SIDE))
+            ? SIDE::BLACK_SIDE
+            : SIDE::WHITE_SIDE;
+        setCell(undo.enPassantCapturedPawn, makeCell(PIECE::Pion, capturedSide, true));
+    }
 
-    Vec2 current = { static_cast<uint8_t>(from.x + stepX), static_cast<uint8_t>(from.y + stepY) };
+    const bool wasCastling = (moved.piece == static_cast<uint8_t>(PIECE::King) &&
+                              std::abs(static_cast<int>(to.x) - static_cast<int>(from.x)) == 2);
+    if (wasCastling) {
+        const bool kingSide = (to.x > from.x);
+        const Vec2 rookFromPos{ static_cast<uint8_t>(kingSide ? 7 : 0), from.y };
+        const Vec2 rookToPos{ static_cast<uint8_t>(kingSide ? 5 : 3), from.y };
+        setCell(rookFromPos, At(rookToPos));
+        setCell(rookToPos, BoardCell{});
+    }
 
-    while (current.x != to.x || current.y != to.y) {
-        if (At(current).fill == 1) {
-            return false; // Chemin bloqué
-        }
-        current.x += stepX;
-        current.y += stepY;
+    restoreCastlingState(undo.castlingState);
+    enPassantActive = undo.enPassantActive;
+    enPassantTarget = undo.enPassantTarget;
+    enPassantCapturedPawn = undo.enPassantCapturedPawn;
+    activeSide = static_cast<SIDE>(moved.side);
+    halfmoveClock = undo.halfmoveClock;
+    if (activeSide == SIDE::BLACK_SIDE) {
+        --fullmoveNumber;
     }
 
-    return true;
+    hashKey ^= Zobrist::KEYS.castling[castlingRights()] ^ enPassantKey();
+    assert(hashKey == computeHash());
 }
 
-// Function to find king position
-Vec2 Core::findKing(SIDE side) const {
-    for (uint8_t y = 0; y < 8; ++y) {
-        for (uint8_t x = 0; x < 8; ++x) {
-            const BoardCell& cell = At({x, y});
-            if (cell.fill == 1 && 
-                cell.side == static_cast<uint8_t>(side) && 
-                cell.piece == static_cast<uint8_t>(PIECE::King)) {
-                return {x, y};
-            }
+Core::UndoInfo Core::makeNullMove() {
+    const UndoInfo undo{
+        BoardCell{},
+        BoardCell{},
+        packCastlingState(),
+        enPassantActive,
+        enPassantTarget,
+        enPassantCapturedPawn,
+        halfmoveClock
+    };
+
+    hashKey ^= enPassantKey() ^ Zobrist::KEYS.blackToMove;
+    enPassantActive = false;
+    ++halfmoveClock;
+    if (activeSide == SIDE::BLACK_SIDE) {
+        ++fullmoveNumber;
+    }
+    activeSide = (activeSide == SIDE::WHITE_SIDE) ? SIDE::BLACK_SIDE : SIDE::WHITE_SIDE;
+    assert(hashKey == computeHash());
+
+    return undo;
+}
+
+void Core::unmakeNullMove(const UndoInfo& undo) {
+    activeSide = (activeSide == SIDE::WHITE_SIDE) ? SIDE::BLACK_SIDE : SIDE::WHITE_SIDE;
+    if (activeSide == SIDE::BLACK_SIDE) {
+        --fullmoveNumber;
+    }
+    halfmoveClock = undo.halfmoveClock;
+    enPassantActive = undo.enPassantActive;
+    enPassantTarget = undo.enPassantTarget;
+    enPassantCapturedPawn = undo.enPassantCapturedPawn;
+    hashKey ^= enPassantKey() ^ Zobrist::KEYS.blackToMove;
+    assert(hashKey == computeHash());
+}
+
+uint64_t Core::computeHash() const
+{
+    uint64_t key = 0;
+    for (uint8_t square = 0; square < 64; ++square) {
+        const BoardCell cell = chessBoard[square];
+        if (cell.fill == 1) {
+            key ^= Zobrist::KEYS.pieces[cell.side][cell.piece][square];
         }
     }
-    // This should never happen in a valid chess game
-    return {0, 0};
+    key ^= Zobrist::KEYS.castling[castlingRights()] ^ enPassantKey();
+    if (activeSide == SIDE::BLACK_SIDE) {
+        key ^= Zobrist::KEYS.blackToMove;
+    }
+    return key;
 }
 
-bool Core::isKingInCheck(SIDE kingSide) const {
-    Vec2 kingPos = findKing(kingSide);
-    SIDE opponentSide = (kingSide == SIDE::WHITE_SIDE) ? SIDE::BLACK_SIDE : SIDE::WHITE_SIDE;
-    return isSquareAttacked(kingPos, opponentSide);
+uint8_t Core::castlingRights() const
+{
+    return static_cast<uint8_t>((!whiteKingMoved && !whiteRookMoved[1])
+        | ((!whiteKingMoved && !whiteRookMoved[0]) << 1)
+        | ((!blackKingMoved && !blackRookMoved[1]) << 2)
+        | ((!blackKingMoved && !blackRookMoved[0]) << 3));
 }
 
-bool Core::movePiece(const Vec2& from, const Vec2& to) {
-    if (!isMoveLegal(from, to)) {
-        return false;
+// The en-passant file only counts when the side to move has a pawn that could take,
+// otherwise identical positions would hash apart after any double push
+uint64_t Core::enPassantKey() const
+{
+    if (!enPassantActive) {
+        return 0;
     }
+    const SIDE mover = (activeSide == SIDE::WHITE_SIDE) ? SIDE::BLACK_SIDE : SIDE::WHITE_SIDE;
+    const Bitboard capturers = Attacks::pawn(mover, toSquare(enPassantTarget)) & pieces(activeSide, PIECE::Pion);
+    return capturers ? Zobrist::KEYS.enPassantFile[enPassantTarget.x] : 0;
+}
 
-    // Store the original state to restore if the move puts own king in check
-    BoardCell originalFrom = At(from);
-    BoardCell originalTo = At(to);
+namespace
+{
+    Bitboard pieceAttacks(PIECE piece, uint8_t square, Bitboard occupied)
+    {
+        switch (piece) {
+        case PIECE::Knight: return Attacks::knight(square);
+        case PIECE::Bishop: return Attacks::bishop(square, occupied);
+        case PIECE::Rook: return Attacks::rook(square, occupied);
+        case PIECE::Queen: return Attacks::queen(square, occupied);
+        case PIECE::King: return Attacks::king(square);
+        case PIECE::Pion: break;
+        }
+        return EMPTY_BB;
+    }
+}
 
-    bool originalWhiteKingMoved = whiteKingMoved;
-    bool originalBlackKingMoved = blackKingMoved;
-    bool originalWhiteRookMoved[2] = { whiteRookMoved[0], whiteRookMoved[1] };
-    bool originalBlackRookMoved[2] = { blackRookMoved[0], blackRookMoved[1] };
-    bool originalEnPassantActive = enPassantActive;
-    Vec2 originalEnPassantTarget = enPassantTarget;
-    Vec2 originalEnPassantCapturedPawn = enPassantCapturedPawn;
+void Core::generateLegalMoves(SIDE side, MoveList& moves, GenMode mode) const
+{
+    moves.clear();
 
-    bool isCastlingMove = (originalFrom.piece == static_cast<uint8_t>(PIECE::King) &&
-                           std::abs(static_cast<int>(to.x) - static_cast<int>(from.x)) == 2 &&
-                           from.y == to.y);
+    const SIDE opponent = (side == SIDE::WHITE_SIDE) ? SIDE::BLACK_SIDE : SIDE::WHITE_SIDE;
+    const Bitboard own = occupancy(side);
+    const Bitboard enemy = occupancy(opponent);
+    if (countOf(side, PIECE::King) == 0) {
+        return;
+    }
+    const uint8_t kingSq = kingSquareOf(side);
+    const Bitboard kingBB = squareBB(kingSq);
 
-    bool isEnPassantCapture = (originalFrom.piece == static_cast<uint8_t>(PIECE::Pion) &&
-                               enPassantActive &&
-                               to.x == enPassantTarget.x &&
-                               to.y == enPassantTarget.y &&
-                               originalTo.fill == 0);
+    auto push = [&](uint8_t from, uint8_t to) {
+        moves.push(Move{ toVec2(from), toVec2(to), PIECE::King });
+    };
 
-    Vec2 rookFromPos{};
-    Vec2 rookToPos{};
-    BoardCell rookFromOriginal{};
-    BoardCell rookToOriginal{};
-    bool adjustRook = false;
+    // King steps, with the king lifted off the board so sliders see through its old square
+    const bool capturesOnly = (mode == GenMode::Captures);
+    // Where king and piece moves may land: anything not ours, or enemy pieces only
+    const Bitboard targetMask = capturesOnly ? enemy : ~own;
+
+    const Bitboard withoutKing = occupiedBB ^ kingBB;
+    Bitboard kingTargets = Attacks::king(kingSq) & targetMask;
+    while (kingTargets) {
+        const uint8_t to = popLsb(kingTargets);
+        if (!isSquareAttacked(to, opponent, withoutKing)) {
+            push(kingSq, to);
+        }
+    }
 
-    if (isCastlingMove) {
-        bool kingSide = (to.x > from.x);
-        rookFromPos = { static_cast<uint8_t>(kingSide ? 7 : 0), from.y };
-        rookToPos = { static_cast<uint8_t>(kingSide ? 5 : 3), from.y };
-        rookFromOriginal = At(rookFromPos);
-        rookToOriginal = At(rookToPos);
-        adjustRook = true;
+    const Bitboard checkers = attackersTo(kingSq, occupiedBB) & enemy;
+    if (popCount(checkers) > 1) {
+        return; // double check: only the king can move
     }
 
-    BoardCell enPassantCapturedOriginal{};
-    if (isEnPassantCapture) {
-        enPassantCapturedOriginal = At(enPassantCapturedPawn);
+    // Every non-king move must land here: anywhere, or on the checker and the squares blocking it
+    const Bitboard checkMask = checkers
+        ? (Attacks::between(kingSq, lsb(checkers)) | checkers)
+        : ~EMPTY_BB;
+
+    // Enemy sliders lined up with the king through exactly one of our pieces pin it to that ray
+    Bitboard pinned = EMPTY_BB;
+    Bitboard pinRay[64];
+    const Bitboard enemyQueens = pieces(opponent, PIECE::Queen);
+    Bitboard snipers = (Attacks::rook(kingSq, EMPTY_BB) & (pieces(opponent, PIECE::Rook) | enemyQueens))
+        | (Attacks::bishop(kingSq, EMPTY_BB) & (pieces(opponent, PIECE::Bishop) | enemyQueens));
+    while (snipers) {
+        const uint8_t sniper = popLsb(snipers);
+        const Bitboard ray = Attacks::between(kingSq, sniper);
+        const Bitboard blockers = ray & occupiedBB;
+        if (popCount(blockers) == 1 && (blockers & own)) {
+            pinned |= blockers;
+            pinRay[lsb(blockers)] = ray | squareBB(sniper);
+        }
     }
 
-    // Make the move
-    auto& fromCase = At(from);
-    auto& toCase = At(to);
+    auto allowedTargets = [&](uint8_t from) {
+        return (pinned & squareBB(from)) ? (checkMask & pinRay[from]) : checkMask;
+    };
 
-    const bool capturedDestination = (originalTo.fill == 1);
-    std::optional<Vec2> enPassantCaptured = std::nullopt;
-    if (isEnPassantCapture) {
-        enPassantCaptured = enPassantCapturedPawn;
-    }
-    std::optional<std::pair<Vec2, Vec2>> rookMoveInfo = std::nullopt;
-    if (adjustRook) {
-        rookMoveInfo = std::make_pair(rookFromPos, rookToPos);
+    for (PIECE piece : { PIECE::Knight, PIECE::Bishop, PIECE::Rook, PIECE::Queen }) {
+        Bitboard fromSquares = pieces(side, piece);
+        while (fromSquares) {
+            const uint8_t from = popLsb(fromSquares);
+            Bitboard targets = pieceAttacks(piece, from, occupiedBB) & targetMask & allowedTargets(from);
+            while (targets) {
+                push(from, popLsb(targets));
+            }
+        }
     }
 
-    toCase.piece = fromCase.piece;
-    toCase.side = fromCase.side;
-    toCase.fill = 1;
-    fromCase.raw = 0;
+    // Pawns: white moves towards y == 0, black towards y == 7
+    const bool white = (side == SIDE::WHITE_SIDE);
+    const int forward = white ? -8 : 8;
+    const uint8_t startRow = white ? 6 : 1;
+    const uint8_t promotionRow = white ? 0 : 7;
 
-    if (isEnPassantCapture) {
-        At(enPassantCapturedPawn).raw = 0;
-    }
+    auto pushPawnMove = [&](uint8_t from, uint8_t to) {
+        if ((to >> 3) == promotionRow) {
+            for (PIECE promotion : { PIECE::Queen, PIECE::Rook, PIECE::Bishop, PIECE::Knight }) {
+                moves.push(Move{ toVec2(from), toVec2(to), promotion });
+            }
+        } else {
+            push(from, to);
+        }
+    };
 
-    if (adjustRook) {
-        auto& rookFromCase = At(rookFromPos);
-        auto& rookToCase = At(rookToPos);
-        rookToCase = rookFromCase;
-        rookFromCase.raw = 0;
-    }
+    const Bitboard enPassantPawn = enPassantActive
+        ? (squareBB(enPassantCapturedPawn) & pieces(opponent, PIECE::Pion))
+        : EMPTY_BB;
 
-    // Check if the move puts/leaves own king in check
-    SIDE movingSide = static_cast<SIDE>(originalFrom.side);
+    Bitboard pawns = pieces(side, PIECE::Pion);
+    while (pawns) {
+        const uint8_t from = popLsb(pawns);
+        const Bitboard allowed = allowedTargets(from);
 
-    if (originalFrom.piece == static_cast<uint8_t>(PIECE::King)) {
-        if (movingSide == SIDE::WHITE_SIDE) {
-            whiteKingMoved = true;
-        } else {
-            blackKingMoved = true;
+        // Quiet pushes only count as tactical when they promote
+        const uint8_t single = static_cast<uint8_t>(from + forward);
+        if ((occupiedBB & squareBB(single)) == 0 && (!capturesOnly || (single >> 3) == promotionRow)) {
+            if (allowed & squareBB(single)) {
+                pushPawnMove(from, single);
+            }
+            const uint8_t twice = static_cast<uint8_t>(single + forward);
+            if (!capturesOnly && (from >> 3) == startRow && (occupiedBB & squareBB(twice)) == 0 && (allowed & squareBB(twice))) {
+                push(from, twice);
+            }
         }
-        if (isCastlingMove) {
-            markRookMoved(movingSide, to.x > from.x);
+
+        Bitboard captures = Attacks::pawn(side, from) & enemy & allowed;
+        while (captures) {
+            pushPawnMove(from, popLsb(captures));
+        }
+
+        // Taking en passant empties two squares on one rank, so check the resulting occupancy directly
+        if (enPassantPawn && (Attacks::pawn(side, from) & squareBB(enPassantTarget))) {
+            const uint8_t target = toSquare(enPassantTarget);
+            const Bitboard after = (occupiedBB ^ squareBB(from) ^ enPassantPawn) | squareBB(target);
+            if ((attackersTo(kingSq, after) & enemy & ~enPassantPawn) == 0) {
+                push(from, target);
+            }
         }
     }
 
-    if (originalFrom.piece == static_cast<uint8_t>(PIECE::Rook)) {
-        if (from.y == (movingSide == SIDE::WHITE_SIDE ? 7 : 0)) {
-            if (from.x == 0) {
-                markRookMoved(movingSide, false);
-            } else if (from.x == 7) {
-                markRookMoved(movingSide, true);
+    // Castling keeps the existing rules: king and rook unmoved, empty path, no attacked square crossed
+    const Vec2 kingPos = toVec2(kingSq);
+    const bool kingMoved = white ? whiteKingMoved : blackKingMoved;
+    if (!capturesOnly && checkers == EMPTY_BB && !kingMoved && kingPos.x == 4) {
+        for (bool kingSide : { true, false }) {
+            if (hasRookMoved(side, kingSide)) {
+                continue;
+            }
+            const uint8_t rookSquare = static_cast<uint8_t>(kingPos.y * 8 + (kingSide ? 7 : 0));
+            if ((pieces(side, PIECE::Rook) & squareBB(rookSquare)) == 0 ||
+                (Attacks::between(kingSq, rookSquare) & occupiedBB) != 0) {
+                continue;
+            }
+            const uint8_t step = kingSide ? kingSq + 1 : kingSq - 1;
+            const uint8_t to = kingSide ? kingSq + 2 : kingSq - 2;
+            if (!isSquareAttacked(step, opponent, occupiedBB) && !isSquareAttacked(to, opponent, occupiedBB)) {
+                push(kingSq, to);
             }
         }
     }
+}
 
-    if (originalTo.fill == 1 &&
-        originalTo.piece == static_cast<uint8_t>(PIECE::Rook) &&
-        originalTo.side != originalFrom.side) {
-        handleRookCapture(to, static_cast<SIDE>(originalTo.side));
+int Core::see(const Move& move) const
+{
+    // Exchange values only, independent from the engine's evaluation weights
+    static constexpr int SEE_VALUES[6] = { 20000, 900, 330, 320, 500, 100 };
+    static constexpr PIECE CHEAPEST_FIRST[6] = {
+        PIECE::Pion, PIECE::Knight, PIECE::Bishop, PIECE::Rook, PIECE::Queen, PIECE::King
+    };
+
+    const uint8_t from = toSquare(move.from);
+    const uint8_t to = toSquare(move.to);
+    const BoardCell mover = chessBoard[from];
+    const BoardCell target = chessBoard[to];
+    const bool promotes = (move.promotion != PIECE::King);
+
+    Bitboard occupied = occupiedBB ^ squareBB(from);
+    int gain[32];
+    gain[0] = 0;
+
+    if (target.fill) {
+        gain[0] = SEE_VALUES[target.piece];
+    } else if (mover.piece == static_cast<uint8_t>(PIECE::Pion) && move.from.x != move.to.x) {
+        // En passant: the victim is not on the target square
+        gain[0] = SEE_VALUES[static_cast<int>(PIECE::Pion)];
+        occupied ^= squareBB(enPassantCapturedPawn);
+    }
+    if (promotes) {
+        gain[0] += SEE_VALUES[static_cast<int>(move.promotion)] - SEE_VALUES[static_cast<int>(PIECE::Pion)];
     }
 
-    enPassantActive = false;
-    if (originalFrom.piece == static_cast<uint8_t>(PIECE::Pion)) {
-        int direction = (movingSide == SIDE::WHITE_SIDE) ? -1 : 1;
-        if (static_cast<int>(to.y) - static_cast<int>(from.y) == 2 * direction) {
-            enPassantActive = true;
-            enPassantTarget = { static_cast<uint8_t>(from.x), static_cast<uint8_t>(from.y + direction) };
-            enPassantCapturedPawn = to;
+    const Bitboard diagonal = pieces(SIDE::WHITE_SIDE, PIECE::Bishop) | pieces(SIDE::BLACK_SIDE, PIECE::Bishop)
+        | pieces(SIDE::WHITE_SIDE, PIECE::Queen) | pieces(SIDE::BLACK_SIDE, PIECE::Queen);
+    const Bitboard straight = pieces(SIDE::WHITE_SIDE, PIECE::Rook) | pieces(SIDE::BLACK_SIDE, PIECE::Rook)
+        | pieces(SIDE::WHITE_SIDE, PIECE::Queen) | pieces(SIDE::BLACK_SIDE, PIECE::Queen);
+
+    Bitboard attackers = attackersTo(to, occupied) & occupied;
+    // Value of whatever stands on the target square, the next thing to be taken
+    int onSquare = promotes ? SEE_VALUES[static_cast<int>(move.promotion)] : SEE_VALUES[mover.piece];
+    uint8_t stm = mover.side ^ 1;
+
+    int depth = 0;
+    while (depth < 31) {
+        const Bitboard ours = attackers & sideBB[stm];
+        if (!ours) {
+            break;
         }
-    }
 
-    if (isKingInCheck(movingSide)) {
-        // Restore the original position
-        At(from) = originalFrom;
-        At(to) = originalTo;
-        if (isEnPassantCapture) {
-            At(enPassantCapturedPawn) = enPassantCapturedOriginal;
-        }
-        if (adjustRook) {
-            At(rookFromPos) = rookFromOriginal;
-            At(rookToPos) = rookToOriginal;
-        }
-        // std::cout << "Move would put/leave own king in check\n";
-        whiteKingMoved = originalWhiteKingMoved;
-        blackKingMoved = originalBlackKingMoved;
-        whiteRookMoved[0] = originalWhiteRookMoved[0];
-        whiteRookMoved[1] = originalWhiteRookMoved[1];
-        blackRookMoved[0] = originalBlackRookMoved[0];
-        blackRookMoved[1] = originalBlackRookMoved[1];
-        enPassantActive = originalEnPassantActive;
-        enPassantTarget = originalEnPassantTarget;
-        enPassantCapturedPawn = originalEnPassantCapturedPawn;
-        return false;
-    }
+        PIECE capturer = PIECE::King;
+        Bitboard capturerBB = EMPTY_BB;
+        for (PIECE piece : CHEAPEST_FIRST) {
+            capturerBB = ours & pieceBB[stm][static_cast<int>(piece)];
+            if (capturerBB) {
+                capturer = piece;
+                break;
+            }
+        }
 
-    if (originalFrom.piece == static_cast<uint8_t>(PIECE::Pion)) {
-        if ((movingSide == SIDE::WHITE_SIDE && to.y == 0) ||
-            (movingSide == SIDE::BLACK_SIDE && to.y == 7)) {
-            BoardCell& promoted = At(to);
-            promoted.piece = static_cast<uint8_t>(PIECE::Queen);
+        // The king may only take last, when nothing guards the square any more
+        if (capturer == PIECE::King && (attackers & sideBB[stm ^ 1])) {
+            break;
         }
-    }
 
-    updateCache(from, to, capturedDestination, enPassantCaptured, rookMoveInfo);
+        // Net for the side capturing now, if the exchange stopped right here
+        ++depth;
+        gain[depth] = onSquare - gain[depth - 1];
 
-    return true;
+        occupied ^= squareBB(lsb(capturerBB));
+        // Removing the capturer may open a line for a slider behind it
+        attackers |= (Attacks::bishop(to, occupied) & diagonal) | (Attacks::rook(to, occupied) & straight);
+        attackers &= occupied;
+
+        onSquare = SEE_VALUES[static_cast<int>(capturer)];
+        stm ^= 1;
+    }
+
+    // Each side may stop capturing whenever continuing would lose
+    while (depth > 0) {
+        gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
+        --depth;
+    }
+    return gain[0];
 }
 
 std::vector<Vec2> Core::getPossibleMoves(const Vec2 &from) const {
-    std::vector<Vec2> moves;
+    std::vector<Vec2> targets;
 
     // Validate source square
-    if (!isMoveInBounds(from)) return moves;
+    if (!isMoveInBounds(from)) return targets;
     const BoardCell &fromCell = At(from);
-    if (fromCell.fill == 0) return moves;
-
-    const SIDE movingSide = static_cast<SIDE>(fromCell.side);
+    if (fromCell.fill == 0) return targets;
 
-    auto tryAddMove = [&](int targetX, int targetY) {
-        if (targetX < 0 || targetX >= 8 || targetY < 0 || targetY >= 8) {
-            return;
-        }
+    MoveList legalMoves;
+    generateLegalMoves(static_cast<SIDE>(fromCell.side), legalMoves);
 
-        Vec2 to{ static_cast<uint8_t>(targetX), static_cast<uint8_t>(targetY) };
-        const BoardCell &targetCell = At(to);
-        if (targetCell.fill == 1 && targetCell.side == fromCell.side) {
-            return;
+    // One entry per target square, promotions collapse onto the queen move
+    for (const Move& move : legalMoves) {
+        if (move.from == from && (move.promotion == PIECE::King || move.promotion == PIECE::Queen)) {
+            targets.push_back(move.to);
         }
+    }
 
-        if (isMoveLegal(from, to)) {
-            moves.push_back(to);
-        }
-    };
+    return targets;
+}
 
-    auto addSlidingMoves = [&](int stepX, int stepY) {
-        int currentX = static_cast<int>(from.x) + stepX;
-        int currentY = static_cast<int>(from.y) + stepY;
 
-        while (currentX >= 0 && currentX < 8 && currentY >= 0 && currentY < 8) {
-            Vec2 to{ static_cast<uint8_t>(currentX), static_cast<uint8_t>(currentY) };
-            const BoardCell &targetCell = At(to);
 
-            if (targetCell.fill == 1 && targetCell.side == fromCell.side) {
-                break;
-            }
+namespace
+{
+    bool pieceFromSymbol(char symbol, PIECE& piece)
+    {
+        switch (symbol) {
+        case 'k': piece = PIECE::King; return true;
+        case 'q': piece = PIECE::Queen; return true;
+        case 'r': piece = PIECE::Rook; return true;
+        case 'b': piece = PIECE::Bishop; return true;
+        case 'n': piece = PIECE::Knight; return true;
+        case 'p': piece = PIECE::Pion; return true;
+        default: return false;
+        }
+    }
 
-            if (isMoveLegal(from, to)) {
-                moves.push_back(to);
+    // Plain decimal, no sign, fits a uint16_t
+    bool parseCounter(std::string_view field, uint16_t& value)
+    {
+        uint32_t result = 0;
+        for (const char digit : field) {
+            if (digit < '0' || digit > '9') {
+                return false;
             }
-
-            if (targetCell.fill == 1) {
-                break;
+            result = result * 10 + static_cast<uint32_t>(digit - '0');
+            if (result > 0xFFFF) {
+                return false;
             }
+        }
+        value = static_cast<uint16_t>(result);
+        return true;
+    }
 
-            currentX += stepX;
-            currentY += stepY;
+    // Next space separated field of the FEN, empty once the string is exhausted
+    std::string_view nextField(std::string_view fen, size_t& cursor)
+    {
+        while (cursor < fen.size() && fen[cursor] == ' ') {
+            ++cursor;
         }
-    };
+        const size_t start = cursor;
+        while (cursor < fen.size() && fen[cursor] != ' ') {
+            ++cursor;
+        }
+        return fen.substr(start, cursor - start);
+    }
+}
 
-    switch (static_cast<PIECE>(fromCell.piece)) {
-    case PIECE::Pion: {
-        int direction = (movingSide == SIDE::WHITE_SIDE) ? -1 : 1;
-        int startRow = (movingSide == SIDE::WHITE_SIDE) ? 6 : 1;
-
-        // Single step forward
-        int forwardY = static_cast<int>(from.y) + direction;
-        if (forwardY >= 0 && forwardY < 8) {
-            Vec2 forward{ from.x, static_cast<uint8_t>(forwardY) };
-            if (At(forward).fill == 0) {
-                tryAddMove(forward.x, forward.y);
-
-                // Double step from starting rank
-                if (static_cast<int>(from.y) == startRow) {
-                    int doubleForwardY = forwardY + direction;
-                    if (doubleForwardY >= 0 && doubleForwardY < 8) {
-                        Vec2 doubleForward{ from.x, static_cast<uint8_t>(doubleForwardY) };
-                        if (At(doubleForward).fill == 0) {
-                            tryAddMove(doubleForward.x, doubleForward.y);
-                        }
-                    }
-                }
+bool Core::fromFEN(std::string_view fen)
+{
+    size_t cursor = 0;
+    const std::string_view placement = nextField(fen, cursor);
+    const std::string_view side = nextField(fen, cursor);
+    const std::string_view castling = nextField(fen, cursor);
+    const std::string_view enPassant = nextField(fen, cursor);
+    const std::string_view halfmoves = nextField(fen, cursor);
+    const std::string_view fullmoves = nextField(fen, cursor);
+
+    // Piece placement, from the 8th rank (y == 0) down to the 1st
+    BoardCell board[64]{};
+    uint8_t counts[2][6]{};
+    uint8_t x = 0;
+    uint8_t y = 0;
+    for (const char symbol : placement) {
+        if (symbol == '/') {
+            if (x != 8 || y == 7) {
+                return false;
             }
+            ++y;
+            x = 0;
         }
+        else if (symbol >= '1' && symbol <= '8') {
+            x = static_cast<uint8_t>(x + (symbol - '0'));
+            if (x > 8) {
+                return false;
+            }
+        }
+        else {
+            PIECE piece;
+            const bool white = (symbol >= 'A' && symbol <= 'Z');
+            if (x >= 8 || !pieceFromSymbol(static_cast<char>(white ? symbol - 'A' + 'a' : symbol), piece)) {
+                return false;
+            }
+            if (piece == PIECE::Pion && (y == 0 || y == 7)) {
+                return false;
+            }
+            const SIDE pieceSide = white ? SIDE::WHITE_SIDE : SIDE::BLACK_SIDE;
+            if (++counts[static_cast<uint8_t>(pieceSide)][static_cast<uint8_t>(piece)] > MAX_PIECES_PER_TYPE) {
+                return false;
+            }
+            board[y * 8 + x] = makeCell(piece, pieceSide, true);
+            ++x;
+        }
+    }
+    if (x != 8 || y != 7) {
+        return false;
+    }
 
-        // Captures (including en passant handled by isMoveLegal)
-        tryAddMove(static_cast<int>(from.x) - 1, static_cast<int>(from.y) + direction);
-        tryAddMove(static_cast<int>(from.x) + 1, static_cast<int>(from.y) + direction);
-        break;
-    }
-    case PIECE::Knight: {
-        static constexpr int offsets[8][2] = {
-            { 1, 2 },{ 2, 1 },{ 2, -1 },{ 1, -2 },
-            { -1, -2 },{ -2, -1 },{ -2, 1 },{ -1, 2 }
-        };
-        for (const auto &offset : offsets) {
-            tryAddMove(static_cast<int>(from.x) + offset[0], static_cast<int>(from.y) + offset[1]);
-        }
-        break;
-    }
-    case PIECE::Bishop: {
-        addSlidingMoves(1, 1);
-        addSlidingMoves(1, -1);
-        addSlidingMoves(-1, 1);
-        addSlidingMoves(-1, -1);
-        break;
-    }
-    case PIECE::Rook: {
-        addSlidingMoves(1, 0);
-        addSlidingMoves(-1, 0);
-        addSlidingMoves(0, 1);
-        addSlidingMoves(0, -1);
-        break;
-    }
-    case PIECE::Queen: {
-        addSlidingMoves(1, 0);
-        addSlidingMoves(-1, 0);
-        addSlidingMoves(0, 1);
-        addSlidingMoves(0, -1);
-        addSlidingMoves(1, 1);
-        addSlidingMoves(1, -1);
-        addSlidingMoves(-1, 1);
-        addSlidingMoves(-1, -1);
-        break;
-    }
-    case PIECE::King: {
-        for (int dx = -1; dx <= 1; ++dx) {
-            for (int dy = -1; dy <= 1; ++dy) {
-                if (dx == 0 && dy == 0) continue;
-                tryAddMove(static_cast<int>(from.x) + dx, static_cast<int>(from.y) + dy);
+    constexpr uint8_t KING = static_cast<uint8_t>(PIECE::King);
+    if (counts[0][KING] != 1 || counts[1][KING] != 1) {
+        return false;
+    }
+
+    if (side != "w" && side != "b") {
+        return false;
+    }
+    const SIDE toMove = (side == "w") ? SIDE::WHITE_SIDE : SIDE::BLACK_SIDE;
+
+    // A right only survives when king and rook still stand on their original squares
+    auto hasPiece = [&](uint8_t px, uint8_t py, PIECE piece, SIDE pieceSide) {
+        const BoardCell cell = board[py * 8 + px];
+        return cell.fill == 1 && cell.piece == static_cast<uint8_t>(piece) && cell.side == static_cast<uint8_t>(pieceSide);
+    };
+    bool rights[4]{}; // white king side, white queen side, black king side, black queen side
+    if (castling != "-") {
+        if (castling.empty()) {
+            return false;
+        }
+        for (const char symbol : castling) {
+            switch (symbol) {
+            case 'K': rights[0] = true; break;
+            case 'Q': rights[1] = true; break;
+            case 'k': rights[2] = true; break;
+            case 'q': rights[3] = true; break;
+            default: return false;
             }
         }
+    }
+    const bool whiteKingHome = hasPiece(4, 7, PIECE::King, SIDE::WHITE_SIDE);
+    const bool blackKingHome = hasPiece(4, 0, PIECE::King, SIDE::BLACK_SIDE);
+    rights[0] = rights[0] && whiteKingHome && hasPiece(7, 7, PIECE::Rook, SIDE::WHITE_SIDE);
+    rights[1] = rights[1] && whiteKingHome && hasPiece(0, 7, PIECE::Rook, SIDE::WHITE_SIDE);
+    rights[2] = rights[2] && blackKingHome && hasPiece(7, 0, PIECE::Rook, SIDE::BLACK_SIDE);
+    rights[3] = rights[3] && blackKingHome && hasPiece(0, 0, PIECE::Rook, SIDE::BLACK_SIDE);
+
+    // En passant target, ignored unless the pawn that just double pushed is really there
+    bool epActive = false;
+    Vec2 epTarget{ 0, 0 };
+    Vec2 epPawn{ 0, 0 };
+    if (enPassant != "-") {
+        if (enPassant.size() != 2 || enPassant[0] < 'a' || enPassant[0] > 'h') {
+            return false;
+        }
+        const char rank = enPassant[1];
+        if ((toMove == SIDE::WHITE_SIDE && rank != '6') || (toMove == SIDE::BLACK_SIDE && rank != '3')) {
+            return false;
+        }
+        epTarget = { static_cast<uint8_t>(enPassant[0] - 'a'), static_cast<uint8_t>('8' - rank) };
+        epPawn = { epTarget.x, static_cast<uint8_t>(toMove == SIDE::WHITE_SIDE ? epTarget.y + 1 : epTarget.y - 1) };
+        const SIDE pusher = (toMove == SIDE::WHITE_SIDE) ? SIDE::BLACK_SIDE : SIDE::WHITE_SIDE;
+        epActive = hasPiece(epPawn.x, epPawn.y, PIECE::Pion, pusher) && board[toSquare(epTarget)].fill == 0;
+    }
 
-        // Castling moves are validated inside isMoveLegal
-        tryAddMove(static_cast<int>(from.x) + 2, static_cast<int>(from.y));
-        tryAddMove(static_cast<int>(from.x) - 2, static_cast<int>(from.y));
-        break;
+    // Move counters are optional, many EPD style inputs stop after the en-passant field
+    uint16_t halfmoveValue = 0;
+    uint16_t fullmoveValue = 1;
+    if (!halfmoves.empty() && !parseCounter(halfmoves, halfmoveValue)) {
+        return false;
     }
+    if (!fullmoves.empty() && (!parseCounter(fullmoves, fullmoveValue) || fullmoveValue == 0)) {
+        return false;
     }
 
-    return moves;
+    std::copy(std::begin(board), std::end(board), chessBoard);
+    halfmoveClock = halfmoveValue;
+    fullmoveNumber = fullmoveValue;
+    activeSide = toMove;
+    whiteKingMoved = !rights[0] && !rights[1];
+    blackKingMoved = !rights[2] && !rights[3];
+    whiteRookMoved[1] = !rights[0];
+    whiteRookMoved[0] = !rights[1];
+    blackRookMoved[1] = !rights[2];
+    blackRookMoved[0] = !rights[3];
+    enPassantActive = epActive;
+    enPassantTarget = epTarget;
+    enPassantCapturedPawn = epPawn;
+
+    setupCache();
+    return true;
 }
 
+size_t Core::writeFEN(char* out) const
+{
+    static constexpr char SYMBOLS[6] = { 'k', 'q', 'b', 'n', 'r', 'p' };
+    char* cursor = out;
+
+    for (uint8_t y = 0; y < 8; ++y) {
+        int empty = 0;
+        for (uint8_t x = 0; x < 8; ++x) {
+            const BoardCell cell = chessBoard[y * 8 + x];
+            if (cell.fill == 0) {
+                ++empty;
+                continue;
+            }
+            if (empty > 0) {
+                *cursor++ = static_cast<char>('0' + empty);
+                empty = 0;
+            }
+            const char symbol = SYMBOLS[cell.piece];
+            *cursor++ = (cell.side == static_cast<uint8_t>(SIDE::WHITE_SIDE)) ? static_cast<char>(symbol - 'a' + 'A') : symbol;
+        }
+        if (empty > 0) {
+            *cursor++ = static_cast<char>('0' + empty);
+        }
+        if (y < 7) {
+            *cursor++ = '/';
+        }
+    }
+
+    *cursor++ = ' ';
+    *cursor++ = (activeSide == SIDE::WHITE_SIDE) ? 'w' : 'b';
+    *cursor++ = ' ';
+
+    const uint8_t rights = castlingRights();
+    if (rights == 0) {
+        *cursor++ = '-';
+    } else {
+        constexpr char RIGHT_SYMBOLS[4] = { 'K', 'Q', 'k', 'q' };
+        for (int i = 0; i < 4; ++i) {
+            if (rights & (1 << i)) {
+                *cursor++ = RIGHT_SYMBOLS[i];
+            }
+        }
+    }
+    *cursor++ = ' ';
+
+    if (enPassantActive) {
+        *cursor++ = static_cast<char>('a' + enPassantTarget.x);
+        *cursor++ = static_cast<char>('8' - enPassantTarget.y);
+    } else {
+        *cursor++ = '-';
+    }
+
+    auto writeNumber = [&](uint16_t value) {
+        char digits[5];
+        int length = 0;
+        do {
+            digits[length++] = static_cast<char>('0' + value % 10);
+            value = static_cast<uint16_t>(value / 10);
+        } while (value > 0);
+        while (length > 0) {
+            *cursor++ = digits[--length];
+        }
+    };
+
+    *cursor++ = ' ';
+    writeNumber(halfmoveClock);
+    *cursor++ = ' ';
+    writeNumber(fullmoveNumber);
+    *cursor = '\0';
+
+    return static_cast<size_t>(cursor - out);
+}
 
+std::string Core::toFEN() const
+{
+    char buffer[MAX_FEN_LENGTH];
+    return std::string(buffer, writeFEN(buffer));
+}
 
 void Core::fillChessBoard()
 {
@@ -545,67 +955,42 @@ inline bool Core::isMoveInBounds(const Vec2& cell)
     return cell.x < 8 && cell.y < 8;
 }
 
-bool Core::isSquareAttacked(const Vec2& square, SIDE bySide) const
+bool Core::isSquareAttacked(uint8_t square, SIDE bySide, Bitboard occupied) const
 {
-    for (const Vec2& from : filledCell) {
-        const BoardCell& cell = At(from);
-        if (cell.side != static_cast<uint8_t>(bySide)) {
-            continue;
-        }
-
-        int dX = static_cast<int>(square.x) - static_cast<int>(from.x);
-        int dY = static_cast<int>(square.y) - static_cast<int>(from.y);
-        int deltaX = std::abs(dX);
-        int deltaY = std::abs(dY);
-
-        switch (static_cast<PIECE>(cell.piece)) {
-        case PIECE::Pion: {
-            int direction = (bySide == SIDE::WHITE_SIDE) ? -1 : 1;
-            if (dY == direction && deltaX == 1) {
-                return true;
-            }
-            break;
-        }
-        case PIECE::Knight: {
-            if ((deltaX == 1 && deltaY == 2) || (deltaX == 2 && deltaY == 1)) {
-                return true;
-            }
-            break;
-        }
-        case PIECE::Bishop: {
-            if (deltaX == deltaY && deltaX > 0) {
-                if (isPathClear(from, square)) {
-                    return true;
-                }
-            }
-            break;
-        }
-        case PIECE::Rook: {
-            if (deltaX == 0 || deltaY == 0) {
-                if (isPathClear(from, square)) {
-                    return true;
-                }
-            }
-            break;
-        }
-        case PIECE::Queen: {
-            if (deltaX == deltaY || deltaX == 0 || deltaY == 0) {
-                if (isPathClear(from, square)) {
-                    return true;
-                }
-            }
-            break;
-        }
-        case PIECE::King: {
-            if (deltaX <= 1 && deltaY <= 1 && (deltaX + deltaY > 0)) {
-                return true;
-            }
-            break;
-        }
-        }
+    const SIDE defender = (bySide == SIDE::WHITE_SIDE) ? SIDE::BLACK_SIDE : SIDE::WHITE_SIDE;
+
+    // Reverse lookups: a piece attacks `square` iff the same piece on `square` would attack it back
+    if (Attacks::pawn(defender, square) & pieces(bySide, PIECE::Pion)) {
+        return true;
+    }
+    if (Attacks::knight(square) & pieces(bySide, PIECE::Knight)) {
+        return true;
+    }
+    if (Attacks::king(square) & pieces(bySide, PIECE::King)) {
+        return true;
     }
 
-    return false;
+    const Bitboard queens = pieces(bySide, PIECE::Queen);
+    if (Attacks::bishop(square, occupied) & (pieces(bySide, PIECE::Bishop) | queens)) {
+        return true;
+    }
+    return (Attacks::rook(square, occupied) & (pieces(bySide, PIECE::Rook) | queens)) != 0;
+}
+
+Bitboard Core::attackersTo(uint8_t square, Bitboard occupied) const
+{
+    const Bitboard queens = pieces(SIDE::WHITE_SIDE, PIECE::Queen) | pieces(SIDE::BLACK_SIDE, PIECE::Queen);
+    const Bitboard rooks = pieces(SIDE::WHITE_SIDE, PIECE::Rook) | pieces(SIDE::BLACK_SIDE, PIECE::Rook);
+    const Bitboard bishops = pieces(SIDE::WHITE_SIDE, PIECE::Bishop) | pieces(SIDE::BLACK_SIDE, PIECE::Bishop);
+    const Bitboard knights = pieces(SIDE::WHITE_SIDE, PIECE::Knight) | pieces(SIDE::BLACK_SIDE, PIECE::Knight);
+    const Bitboard kings = pieces(SIDE::WHITE_SIDE, PIECE::King) | pieces(SIDE::BLACK_SIDE, PIECE::King);
+
+    return (Attacks::pawn(SIDE::BLACK_SIDE, square) & pieces(SIDE::WHITE_SIDE, PIECE::Pion))
+        | (Attacks::pawn(SIDE::WHITE_SIDE, square) & pieces(SIDE::BLACK_SIDE, PIECE::Pion))
+        | (Attacks::knight(square) & knights)
+        | (Attacks::king(square) & kings)
+        | (Attacks::bishop(square, occupied) & (bishops | queens))
+        | (Attacks::rook(square, occupied) & (rooks | queens));
 }
 
 bool Core::hasRookMoved(SIDE side, bool kingSide) const
@@ -614,6 +999,27 @@ bool Core::hasRookMoved(SIDE side, bool kingSide) const
     return rookArray[kingSide ? 1 : 0];
 }
 
+// Bits 0-1: kings moved (white, black), bits 2-3: white rooks, bits 4-5: black rooks (queen side first)
+uint8_t Core::packCastlingState() const
+{
+    return static_cast<uint8_t>(whiteKingMoved
+        | (blackKingMoved << 1)
+        | (whiteRookMoved[0] << 2)
+        | (whiteRookMoved[1] << 3)
+        | (blackRookMoved[0] << 4)
+        | (blackRookMoved[1] << 5));
+}
+
+void Core::restoreCastlingState(uint8_t state)
+{
+    whiteKingMoved = (state & 0x01) != 0;
+    blackKingMoved = (state & 0x02) != 0;
+    whiteRookMoved[0] = (state & 0x04) != 0;
+    whiteRookMoved[1] = (state & 0x08) != 0;
+    blackRookMoved[0] = (state & 0x10) != 0;
+    blackRookMoved[1] = (state & 0x20) != 0;
+}
+
 void Core::markRookMoved(SIDE side, bool kingSide)
 {
     bool* rookArray = (side == SIDE::WHITE_SIDE) ? whiteRookMoved : blackRookMoved;
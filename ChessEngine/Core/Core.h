@@ -9,66 +9,141 @@
 #include <array>
 #include <map>
 #include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 #include "definition.h"
+#include "Bitboard.h"
+#include "MoveList.h"
+#include "Position.h"
 
 
 class Core {
 
 public:
 	explicit Core();
+	explicit Core(const Position& position);
 	~Core() = default;
 
-	void debugDisplayChessBoard() const;
-	[[nodiscard]] bool isMoveLegal(const Vec2& from, const Vec2& to) const;
-    bool isPathClear(const Vec2& from, const Vec2& to) const;
-    bool movePiece(const Vec2& from, const Vec2& to);
-    [[nodiscard]] bool isKingInCheck(SIDE kingSide) const;
-    std::vector<Vec2> getPossibleMoves(const Vec2& from) const;
-    [[nodiscard]] Vec2 findKing(SIDE side) const;
-
+	static constexpr std::string_view START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
 
-    void setupCache();
-        void updateCache(const Vec2& from,
-            const Vec2& to,
-            bool capturedDestination,
-            std::optional<Vec2> enPassantCaptured,
-            std::optional<std::pair<Vec2, Vec2>> rookMove);
-
-    void renewCache() {};
+	// Loads a position from Forsyth-Edwards Notation and rebuilds every cache. On
+	// malformed input returns false and leaves the current position untouched.
+	// Allocation free, meant for bulk ingestion. Move counters are optional.
+	bool fromFEN(std::string_view fen);
+	[[nodiscard]] std::string toFEN() const;
 
+	// Longest FEN toFEN can produce, including the terminating null
+	static constexpr size_t MAX_FEN_LENGTH = 96;
+	// Writes the FEN into `out` (at least MAX_FEN_LENGTH bytes), returns its length
+	size_t writeFEN(char* out) const;
 
-    // setup cache
-    // update cache 
-    // renew cache
+	// Compact copy of the position for another thread, and back. load rebuilds
+	// every cache from the snapshot.
+	[[nodiscard]] Position snapshot() const;
+	void load(const Position& position);
 
-    std::vector<Vec2> filledCell;
+	void debugDisplayChessBoard() const;
+    bool isPathClear(const Vec2& from, const Vec2& to) const;
+    bool movePiece(const Vec2& from, const Vec2& to, PIECE promotion = PIECE::Queen);
+    [[nodiscard]] bool isKingInCheck(SIDE kingSide) const;
+    std::vector<Vec2> getPossibleMoves(const Vec2& from) const;
 
+    enum class GenMode : uint8_t {
+        All,
+        Captures    // captures, en passant and promotions only, for quiescence search
+    };
+
+    // Legal moves only: pins and check evasions are worked out once per call,
+    // so every emitted move can be played without a king-safety test
+    void generateLegalMoves(SIDE side, MoveList& moves, GenMode mode = GenMode::All) const;
+
+    // Static exchange evaluation: material balance in centipawns for the side
+    // playing `move` once every capture on its target square has been traded off
+    // in least-valuable-attacker order. Sliders behind the exchanging pieces
+    // (x-rays) join as the line opens. Pins are ignored.
+    [[nodiscard]] int see(const Move& move) const;
+
+    // What makeMove overwrites and cannot rebuild from the move itself, one per ply
+    struct UndoInfo {
+        BoardCell moved;            // piece on `from` before the move (still a pawn when promoting)
+        BoardCell captured;         // content of `to` before the move, empty for en passant
+        uint8_t castlingState;      // packed king/rook moved flags
+        bool enPassantActive;
+        Vec2 enPassantTarget;
+        Vec2 enPassantCapturedPawn;
+        uint16_t halfmoveClock;
+    };
+
+    // Plays a move coming from generateLegalMoves, no validation.
+    // unmakeMove with the returned record restores the exact previous position.
+    [[nodiscard]] UndoInfo makeMove(const Move& move);
+    void unmakeMove(const Move& move, const UndoInfo& undo);
+
+    // Passes the turn for null-move pruning: flips the side to move and clears en
+    // passant, the board is untouched. Never while in check.
+    [[nodiscard]] UndoInfo makeNullMove();
+    void unmakeNullMove(const UndoInfo& undo);
+    [[nodiscard]] Vec2 findKing(SIDE side) const;
 
-    // move generation 
+    // Zobrist key over pieces, side to move, castling rights and a capturable en-passant file.
+    // Kept up to date incrementally by makeMove/unmakeMove, computeHash rebuilds it from scratch.
+    [[nodiscard]] uint64_t hash() const { return hashKey; }
+    [[nodiscard]] uint64_t computeHash() const;
 
-	// make a fake move and see if we can get 
-    // 
+    [[nodiscard]] SIDE sideToMove() const { return activeSide; }
 
+    // Plies since the last capture or pawn move, and the move number as written in FEN
+    [[nodiscard]] uint16_t getHalfmoveClock() const { return halfmoveClock; }
+    [[nodiscard]] uint16_t getFullmoveNumber() const { return fullmoveNumber; }
 
+    // Bit 0/1: white king/queen side, bit 2/3: black king/queen side
+    [[nodiscard]] uint8_t castlingRights() const;
 
 
+    // Rebuilds bitboards, piece lists, king squares and hash from the mailbox
+    void setupCache();
 
+    // Squares of every `piece` of `side`, in no particular order
+    [[nodiscard]] std::span<const uint8_t> pieceSquares(SIDE side, PIECE piece) const {
+        const uint8_t s = static_cast<uint8_t>(side);
+        const uint8_t p = static_cast<uint8_t>(piece);
+        return { pieceList[s][p], pieceCount[s][p] };
+    }
+    [[nodiscard]] uint8_t countOf(SIDE side, PIECE piece) const {
+        return pieceCount[static_cast<uint8_t>(side)][static_cast<uint8_t>(piece)];
+    }
+    [[nodiscard]] uint8_t kingSquareOf(SIDE side) const { return kingSquare[static_cast<uint8_t>(side)]; }
+
+	// Mailbox view of the position, writes go through setCell so the bitboards stay in sync
 	[[nodiscard]] const BoardCell& At(const Vec2& pos) const { return chessBoard[pos.y * 8 + pos.x];  };
-        [[nodiscard]] BoardCell& At(const Vec2& pos) { return chessBoard[pos.y * 8 + pos.x]; };
+
+        // Bitboard view of the position, maintained by movePiece
+        [[nodiscard]] Bitboard pieces(SIDE side, PIECE piece) const {
+            return pieceBB[static_cast<uint8_t>(side)][static_cast<uint8_t>(piece)];
+        }
+        [[nodiscard]] Bitboard occupancy(SIDE side) const { return sideBB[static_cast<uint8_t>(side)]; }
+        [[nodiscard]] Bitboard occupancy() const { return occupiedBB; }
 
 private:
-        void removeFromCache(const Vec2& pos);
+        void setCell(const Vec2& pos, BoardCell cell);
 
         void fillChessBoard();
         
         [[nodiscard]] static inline bool isMoveInBounds(const Vec2& cell) ;
 
-        bool isSquareAttacked(const Vec2& square, SIDE bySide) const;
+        bool isSquareAttacked(uint8_t square, SIDE bySide, Bitboard occupied) const;
+        // Pieces of both sides attacking `square` given the `occupied` blockers
+        [[nodiscard]] Bitboard attackersTo(uint8_t square, Bitboard occupied) const;
 
         bool hasRookMoved(SIDE side, bool kingSide) const;
+        [[nodiscard]] uint8_t packCastlingState() const;
+        void restoreCastlingState(uint8_t state);
+        [[nodiscard]] uint64_t enPassantKey() const;
         void markRookMoved(SIDE side, bool kingSide);
         void handleRookCapture(const Vec2& pos, SIDE capturedSide);
 
@@ -76,6 +151,19 @@ private:
 
         // std::map<SIDE, std::map<PIECE, uint8_t>> takenPiecesCount;
 
+        // 1D array to use full one line of cache 64 bits
+        alignas(64) BoardCell chessBoard[64]{};
+
+        // indexed by [side][piece], same square numbering as chessBoard
+        Bitboard pieceBB[2][6]{};
+        Bitboard sideBB[2]{};
+        Bitboard occupiedBB{ 0 };
+
+        uint64_t hashKey{ 0 };
+        SIDE activeSide{ SIDE::WHITE_SIDE };
+        uint16_t halfmoveClock{ 0 };
+        uint16_t fullmoveNumber{ 1 };
+
         bool whiteKingMoved{ false };
         bool blackKingMoved{ false };
         bool whiteRookMoved[2]{ false, false };
@@ -85,10 +173,17 @@ private:
         Vec2 enPassantTarget{ 0, 0 };
         Vec2 enPassantCapturedPawn{ 0, 0 };
 
-
-        // 1D array to use full one line of cache 64 bits
-        alignas(64) BoardCell chessBoard[64]{};
+        // Piece lists: fixed slots per [side][piece], pieceIndex maps a square to its slot
+        // so removal is a swap with the last entry. Two originals plus eight promotions fit.
+        static constexpr uint8_t MAX_PIECES_PER_TYPE = 10;
+        uint8_t pieceList[2][6][MAX_PIECES_PER_TYPE]{};
+        uint8_t pieceCount[2][6]{};
+        uint8_t pieceIndex[64]{};
+        uint8_t kingSquare[2]{};
 };
 
+// Copying a position is a plain memcpy, no heap member left
+static_assert(std::is_trivially_copyable_v<Core>, "Core must stay trivially copyable");
+
 
 #endif //CHESSENGINEPROJECT_CORE_H
\ No newline at end of file
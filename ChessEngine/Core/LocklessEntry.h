@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// One slot of a hash table shared by many threads without locks, used by the
+// transposition table and the perft cache. The slot stores `data` and
+// `key ^ data`. If two racing stores tear an entry, the key read back no longer
+// matches, and the probe just sees a miss.
+struct LocklessEntry {
+	std::atomic<uint64_t> check{ 0 };  // key ^ data
+	std::atomic<uint64_t> data{ 0 };
+
+	// Reads the key the payload was stored under, garbage after a torn write
+	void load(uint64_t& key, uint64_t& payload) const {
+		payload = data.load(std::memory_order_relaxed);
+		key = check.load(std::memory_order_relaxed) ^ payload;
+	}
+
+	void save(uint64_t key, uint64_t payload) {
+		check.store(key ^ payload, std::memory_order_relaxed);
+		data.store(payload, std::memory_order_relaxed);
+	}
+
+	void clear() { save(0, 0); }
+};
+
+static_assert(sizeof(LocklessEntry) == 16, "LocklessEntry must stay 16 bytes");
+
+// Largest power of two slot count fitting in `megabytes`, so indexing is a mask.
+// 0 when the budget is 0 MB.
+inline size_t hashSlotCount(size_t megabytes, size_t slotSize) {
+	const size_t budget = megabytes * 1024 * 1024 / slotSize;
+	if (budget == 0) {
+		return 0;
+	}
+	size_t count = 1;
+	while (count * 2 <= budget) {
+		count *= 2;
+	}
+	return count;
+}
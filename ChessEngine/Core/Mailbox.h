@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+// Latest-value mailbox between one writer and one reader (a triple buffer). The
+// writer fills its private slot and swaps it with the shared middle one, the
+// reader swaps the middle one with its own slot when it is flagged fresh. Neither
+// side ever waits, and a value nobody read in time is simply overwritten.
+template <typename T>
+class Mailbox {
+	static_assert(std::is_trivially_copyable_v<T>, "Mailbox values are copied around freely");
+
+public:
+	// Writer only
+	void publish(const T& value) {
+		buffers[backIndex] = value;
+		const uint8_t previous = middle.exchange(static_cast<uint8_t>(backIndex | FRESH), std::memory_order_acq_rel);
+		backIndex = previous & INDEX_MASK;
+	}
+
+	// Reader only. True with the newest value when something was published since
+	// the last successful read.
+	bool read(T& out) {
+		if ((middle.load(std::memory_order_relaxed) & FRESH) == 0) {
+			return false;
+		}
+		const uint8_t previous = middle.exchange(frontIndex, std::memory_order_acq_rel);
+		frontIndex = previous & INDEX_MASK;
+		out = buffers[frontIndex];
+		return true;
+	}
+
+private:
+	static constexpr uint8_t INDEX_MASK = 3;
+	static constexpr uint8_t FRESH = 4;
+
+	T buffers[3]{};
+	alignas(64) std::atomic<uint8_t> middle{ 1 };  // slot index, plus FRESH once written
+	uint8_t backIndex = 0;                         // writer's slot
+	uint8_t frontIndex = 2;                        // reader's slot
+};
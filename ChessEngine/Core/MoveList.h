@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+#include "definition.h"
+
+// Fixed-capacity move buffer meant to live on the stack: no heap traffic during
+// generation. 256 is above the largest legal move count of any position (218).
+// Entries past size() are left uninitialized.
+class MoveList {
+
+public:
+	static constexpr uint16_t CAPACITY = 256;
+
+	void push(const Move& move) { moves[count++] = move; }
+	void clear() { count = 0; }
+
+	[[nodiscard]] uint16_t size() const { return count; }
+	[[nodiscard]] bool empty() const { return count == 0; }
+
+	[[nodiscard]] Move& operator[](uint16_t index) { return moves[index]; }
+	[[nodiscard]] const Move& operator[](uint16_t index) const { return moves[index]; }
+
+	[[nodiscard]] Move* begin() { return moves; }
+	[[nodiscard]] Move* end() { return moves + count; }
+	[[nodiscard]] const Move* begin() const { return moves; }
+	[[nodiscard]] const Move* end() const { return moves + count; }
+
+private:
+	Move moves[CAPACITY];
+	uint16_t count = 0;
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "definition.h"
+
+#include <cstdint>
+#include <type_traits>
+
+// Plain value copy of everything that defines a position, without Core's derived
+// caches (bitboards, piece lists). This is what crosses threads: the UI takes a
+// snapshot and hands it over by value, so the search never shares the board the
+// UI keeps playing on. 80 bytes, copied with a memcpy.
+struct Position {
+	static constexpr uint8_t NO_EN_PASSANT = 64;
+
+	BoardCell board[64];        // mailbox, same square numbering as Core
+	uint64_t hash;              // Core's Zobrist key for the position
+	uint16_t halfmoveClock;
+	uint16_t fullmoveNumber;
+	uint8_t castlingState;      // Core's packed king/rook moved flags
+	uint8_t enPassantSquare;    // target square of a pawn that just pushed two, or NO_EN_PASSANT
+	SIDE sideToMove;
+};
+
+static_assert(std::is_trivially_copyable_v<Position>, "Position must stay trivially copyable");
+static_assert(sizeof(Position) <= 80, "Position should stay compact");
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Bounded single-producer, single-consumer ring. Exactly one thread pushes and
+// exactly one other thread pops: each index has a single writer, so an
+// acquire/release pair per call is all the synchronisation there is, no lock and
+// no compare-exchange. Capacity must be a power of two.
+template <typename T, size_t Capacity>
+class SpscQueue {
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+	// Producer only. False when the ring is full, nothing is written then.
+	bool push(const T& item) {
+		const size_t tail = tailIndex.load(std::memory_order_relaxed);
+		if (tail - headIndex.load(std::memory_order_acquire) == Capacity) {
+			return false;
+		}
+		slots[tail & MASK] = item;
+		tailIndex.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer only. False when there is nothing to take.
+	bool pop(T& out) {
+		const size_t head = headIndex.load(std::memory_order_relaxed);
+		if (head == tailIndex.load(std::memory_order_acquire)) {
+			return false;
+		}
+		out = slots[head & MASK];
+		headIndex.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	static constexpr size_t MASK = Capacity - 1;
+
+	// Each side spins on its own cache line
+	alignas(64) std::atomic<size_t> headIndex{ 0 };
+	alignas(64) std::atomic<size_t> tailIndex{ 0 };
+	std::array<T, Capacity> slots;
+};
@@ -0,0 +1,169 @@
+#include "TranspositionTable.h"
+#include "Bitboard.h"
+
+#include <algorithm>
+
+TranspositionTable::TranspositionTable(size_t megabytes)
+{
+    resize(megabytes);
+}
+
+void TranspositionTable::resize(size_t megabytes)
+{
+    buckets.reset();
+    bucketCount = 0;
+    generation = 0;
+
+    const size_t count = hashSlotCount(megabytes, sizeof(Bucket));
+    if (count == 0) {
+        return;
+    }
+
+    // Every entry starts zeroed, which decodes as Bound::None
+    buckets = std::make_unique<Bucket[]>(count);
+    bucketCount = count;
+}
+
+void TranspositionTable::clear()
+{
+    for (size_t i = 0; i < bucketCount; ++i) {
+        for (Entry& entry : buckets[i].entries) {
+            entry.clear();
+        }
+    }
+    generation = 0;
+}
+
+uint16_t TranspositionTable::packMove(const Move& move)
+{
+    return static_cast<uint16_t>(toSquare(move.from)
+        | (toSquare(move.to) << 6)
+        | (static_cast<uint16_t>(move.promotion) << 12));
+}
+
+Move TranspositionTable::unpackMove(uint16_t packed)
+{
+    return Move{
+        toVec2(static_cast<uint8_t>(packed & 0x3F)),
+        toVec2(static_cast<uint8_t>((packed >> 6) & 0x3F)),
+        static_cast<PIECE>((packed >> 12) & 0x7)
+    };
+}
+
+TranspositionTable::Fields TranspositionTable::load(const Entry& entry)
+{
+    uint64_t key = 0;
+    uint64_t data = 0;
+    entry.load(key, data);
+    return Fields{
+        key,
+        static_cast<int32_t>(static_cast<uint32_t>(data)),
+        static_cast<uint16_t>(data >> 32),
+        static_cast<int8_t>(static_cast<uint8_t>(data >> 48)),
+        static_cast<uint8_t>(data >> 56)
+    };
+}
+
+void TranspositionTable::save(Entry& entry, const Fields& fields)
+{
+    const uint64_t data = static_cast<uint64_t>(static_cast<uint32_t>(fields.score))
+        | (static_cast<uint64_t>(fields.move) << 32)
+        | (static_cast<uint64_t>(static_cast<uint8_t>(fields.depth)) << 48)
+        | (static_cast<uint64_t>(fields.genBound) << 56);
+    entry.save(fields.key, data);
+}
+
+bool TranspositionTable::probe(uint64_t key, ProbeResult& out) const
+{
+    if (!buckets) {
+        return false;
+    }
+
+    const Bucket& bucket = buckets[key & (bucketCount - 1)];
+    for (const Entry& slot : bucket.entries) {
+        const Fields entry = load(slot);
+        if (entry.key != key || (entry.genBound & 0x3) == 0) {
+            continue;
+        }
+        out.score = entry.score;
+        out.depth = entry.depth;
+        out.bound = static_cast<Bound>(entry.genBound & 0x3);
+        out.hasMove = entry.move != 0;
+        out.move = unpackMove(entry.move);
+        return true;
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, int depth, int score, Bound bound, const Move* move)
+{
+    if (!buckets) {
+        return;
+    }
+
+    Bucket& bucket = buckets[key & (bucketCount - 1)];
+
+    // Same position already cached: overwrite in place. Otherwise evict the entry
+    // worth least, shallow and stale ones first.
+    Entry* victim = &bucket.entries[0];
+    Fields old = load(*victim);
+    int victimWorth = INT32_MAX;
+    for (Entry& slot : bucket.entries) {
+        const Fields entry = load(slot);
+        if (entry.key == key) {
+            victim = &slot;
+            old = entry;
+            break;
+        }
+        const int worth = entry.depth - 8 * relativeAge(entry.genBound);
+        if (worth < victimWorth) {
+            victimWorth = worth;
+            victim = &slot;
+            old = entry;
+        }
+    }
+
+    // Keep the previous best move if this result did not find one
+    uint16_t packed = move ? packMove(*move) : 0;
+    if (packed == 0 && old.key == key) {
+        packed = old.move;
+    }
+
+    // A shallower non-exact result for the same position from this search is not
+    // worth losing a deeper one over
+    if (old.key == key && bound != Bound::Exact && relativeAge(old.genBound) == 0
+        && depth + 2 < old.depth) {
+        if (packed != old.move) {
+            old.move = packed;
+            save(*victim, old);
+        }
+        return;
+    }
+
+    save(*victim, Fields{
+        key,
+        score,
+        packed,
+        static_cast<int8_t>(std::clamp(depth, 0, 127)),
+        static_cast<uint8_t>((generation << 2) | static_cast<uint8_t>(bound))
+    });
+}
+
+int TranspositionTable::hashfull() const
+{
+    if (!buckets) {
+        return 0;
+    }
+
+    const size_t sample = std::min<size_t>(bucketCount, 250);
+    int used = 0;
+    for (size_t i = 0; i < sample; ++i) {
+        for (const Entry& slot : buckets[i].entries) {
+            const Fields entry = load(slot);
+            if ((entry.genBound & 0x3) != 0 && relativeAge(entry.genBound) == 0) {
+                ++used;
+            }
+        }
+    }
+    return static_cast<int>(used * 1000 / (sample * ENTRIES_PER_BUCKET));
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "LocklessEntry.h"
+#include "definition.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Search results keyed by Zobrist hash. Entries are grouped in 64 byte buckets so
+// a probe touches a single cache line. Replacement prefers shallow entries and
+// entries left over from earlier searches (aging through a generation counter).
+// Every search thread shares it without locks, through LocklessEntry.
+class TranspositionTable {
+
+public:
+	enum class Bound : uint8_t {
+		None = 0,
+		Upper = 1,  // fail low, score is at most this
+		Lower = 2,  // fail high, score is at least this
+		Exact = 3
+	};
+
+	struct ProbeResult {
+		int score;
+		int depth;
+		Bound bound;
+		Move move;
+		bool hasMove;
+	};
+
+	explicit TranspositionTable(size_t megabytes = 16);
+
+	// Reallocates and clears, 0 MB disables the table. Not while a search runs.
+	void resize(size_t megabytes);
+	void clear();
+
+	// Call once per search so older entries become preferred victims
+	void newSearch() { generation = static_cast<uint8_t>((generation + 1) & GENERATION_MASK); }
+
+	bool probe(uint64_t key, ProbeResult& out) const;
+	void store(uint64_t key, int depth, int score, Bound bound, const Move* move);
+
+	[[nodiscard]] size_t sizeMegabytes() const { return bucketCount * sizeof(Bucket) / (1024 * 1024); }
+
+	// Rough fill rate in per mille, sampled from the first buckets
+	[[nodiscard]] int hashfull() const;
+
+private:
+	// data: score (32) | move (16) | depth (8) | generation << 2 | bound (8)
+	using Entry = LocklessEntry;
+
+	// Unpacked copy of an entry, what the code actually works on
+	struct Fields {
+		uint64_t key;
+		int32_t score;
+		uint16_t move;       // from | to << 6 | promotion << 12, 0 when none
+		int8_t depth;
+		uint8_t genBound;
+	};
+
+	static constexpr int ENTRIES_PER_BUCKET = 4;
+
+	struct alignas(64) Bucket {
+		Entry entries[ENTRIES_PER_BUCKET];
+	};
+	static_assert(sizeof(Bucket) == 64, "TT bucket must fill exactly one cache line");
+
+	static constexpr uint8_t GENERATION_MASK = 0x3F;
+
+	static uint16_t packMove(const Move& move);
+	static Move unpackMove(uint16_t packed);
+
+	static Fields load(const Entry& entry);
+	static void save(Entry& entry, const Fields& fields);
+
+	// How many searches ago the entry was written, wrapping with the counter
+	[[nodiscard]] int relativeAge(uint8_t genBound) const {
+		return (generation - (genBound >> 2)) & GENERATION_MASK;
+	}
+
+	std::unique_ptr<Bucket[]> buckets;
+	size_t bucketCount = 0;
+	uint8_t generation = 0;
+};
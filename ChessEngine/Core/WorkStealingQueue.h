@@ -0,0 +1,66 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <utility>
+
+// Per-thread task deque for work stealing. The owner pushes and pops at the back
+// (LIFO, stays on the hot, deep end of its own work), thieves take from the front
+// where the oldest and usually largest tasks sit. A short mutex per deque keeps
+// it simple; contention is rare because thieves only show up when idle.
+template <typename T>
+class WorkStealingQueue {
+
+public:
+	void push(const T& item) {
+		std::lock_guard<std::mutex> lock(mutex);
+		items.push_back(item);
+	}
+
+	void push(T&& item) {
+		std::lock_guard<std::mutex> lock(mutex);
+		items.push_back(std::move(item));
+	}
+
+	bool pop(T& out) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (items.empty()) {
+			return false;
+		}
+		out = std::move(items.back());
+		items.pop_back();
+		return true;
+	}
+
+	bool steal(T& out) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (items.empty()) {
+			return false;
+		}
+		out = std::move(items.front());
+		items.pop_front();
+		return true;
+	}
+
+	// Takes the oldest item only when `accept` agrees, for a thread that may run
+	// some of the work but not all of it
+	template <typename Predicate>
+	bool stealIf(T& out, Predicate accept) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (items.empty() || !accept(items.front())) {
+			return false;
+		}
+		out = std::move(items.front());
+		items.pop_front();
+		return true;
+	}
+
+	void clear() {
+		std::lock_guard<std::mutex> lock(mutex);
+		items.clear();
+	}
+
+private:
+	std::mutex mutex;
+	std::deque<T> items;
+};
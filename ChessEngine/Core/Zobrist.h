@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+
+// Zobrist keys, generated at compile time so every build hashes positions identically.
+namespace Zobrist {
+
+	struct Keys {
+		uint64_t pieces[2][6][64];  // [side][piece][square]
+		uint64_t castling[16];      // indexed by Core::castlingRights()
+		uint64_t enPassantFile[8];
+		uint64_t blackToMove;
+	};
+
+	// splitmix64: tiny, constexpr-friendly and well distributed
+	constexpr uint64_t next(uint64_t& state) {
+		uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+
+	constexpr Keys makeKeys() {
+		Keys keys{};
+		uint64_t state = 0x2545F4914F6CDD1DULL;
+		for (auto& side : keys.pieces) {
+			for (auto& piece : side) {
+				for (auto& square : piece) {
+					square = next(state);
+				}
+			}
+		}
+		// No rights at all hashes to nothing, like an empty square
+		keys.castling[0] = 0;
+		for (int i = 1; i < 16; ++i) {
+			keys.castling[i] = next(state);
+		}
+		for (auto& file : keys.enPassantFile) {
+			file = next(state);
+		}
+		keys.blackToMove = next(state);
+		return keys;
+	}
+
+	inline constexpr Keys KEYS = makeKeys();
+}
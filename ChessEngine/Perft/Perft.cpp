@@ -0,0 +1,182 @@
+#include "Perft.h"
+
+#include "Core/WorkStealingQueue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+uint64_t Perft::count(Core& board, int depth, PerftHash* hash, ThreadStats* stats)
+{
+    if (depth <= 0) {
+        return 1;
+    }
+
+    MoveList moves;
+    board.generateLegalMoves(board.sideToMove(), moves);
+    if (depth == 1) {
+        return moves.size();
+    }
+
+    uint64_t nodes = 0;
+    if (hash && hash->probe(board.hash(), depth, nodes)) {
+        if (stats) {
+            ++stats->hashHits;
+        }
+        return nodes;
+    }
+
+    for (const Move& move : moves) {
+        const Core::UndoInfo undo = board.makeMove(move);
+        nodes += count(board, depth - 1, hash, stats);
+        board.unmakeMove(move, undo);
+    }
+
+    if (hash) {
+        hash->store(board.hash(), depth, nodes);
+    }
+    return nodes;
+}
+
+std::vector<Perft::DivideEntry> Perft::divide(Position root, int depth)
+{
+    std::vector<DivideEntry> entries;
+    if (depth <= 0) {
+        return entries;
+    }
+
+    Core board(root);
+    MoveList moves;
+    board.generateLegalMoves(board.sideToMove(), moves);
+    entries.reserve(moves.size());
+
+    for (const Move& move : moves) {
+        const Core::UndoInfo undo = board.makeMove(move);
+        entries.push_back(DivideEntry{ move, count(board, depth - 1) });
+        board.unmakeMove(move, undo);
+    }
+    return entries;
+}
+
+namespace
+{
+    struct Task {
+        Core board;
+        int depth;
+        uint16_t root;  // index of the root move this subtree belongs to
+    };
+
+    // Padded so the hot counters of two workers never share a cache line
+    struct alignas(64) Worker {
+        WorkStealingQueue<Task> queue;
+        Perft::ThreadStats stats;
+    };
+}
+
+Perft::ParallelResult Perft::divideParallel(Position root, int depth, unsigned threads, PerftHash& hash)
+{
+    const Core board(root);
+    ParallelResult result;
+    threads = std::max(1u, threads);
+    result.threads.resize(threads);
+    if (depth <= 0) {
+        return result;
+    }
+
+    MoveList rootMoves;
+    board.generateLegalMoves(board.sideToMove(), rootMoves);
+    for (const Move& move : rootMoves) {
+        result.divide.push_back(DivideEntry{ move, 1 });
+    }
+    if (depth == 1) {
+        return result;
+    }
+
+    // Subtrees deeper than this are expanded into child tasks instead of being
+    // counted in one go: three plies below the root give plenty of tasks to steal
+    const int splitDepth = std::max(2, depth - 3);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (unsigned i = 0; i < threads; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    std::vector<std::atomic<uint64_t>> rootNodes(rootMoves.size());
+    std::atomic<uint64_t> pending{ rootMoves.size() };
+
+    for (uint16_t i = 0; i < rootMoves.size(); ++i) {
+        Task task{ board, depth - 1, i };
+        (void)task.board.makeMove(rootMoves[i]);
+        workers[i % threads]->queue.push(task);
+    }
+
+    auto run = [&](unsigned id) {
+        Worker& self = *workers[id];
+        Task task;
+        while (pending.load(std::memory_order_acquire) != 0) {
+            bool found = self.queue.pop(task);
+            for (unsigned offset = 1; !found && offset < threads; ++offset) {
+                found = workers[(id + offset) % threads]->queue.steal(task);
+                self.stats.steals += found ? 1 : 0;
+            }
+            if (!found) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            ++self.stats.tasks;
+            if (task.depth > splitDepth) {
+                MoveList moves;
+                task.board.generateLegalMoves(task.board.sideToMove(), moves);
+                // Register the children before this task retires so pending never hits 0 early
+                pending.fetch_add(moves.size(), std::memory_order_relaxed);
+                for (const Move& move : moves) {
+                    Task child{ task.board, task.depth - 1, task.root };
+                    (void)child.board.makeMove(move);
+                    self.queue.push(child);
+                }
+            } else {
+                const uint64_t nodes = count(task.board, task.depth, &hash, &self.stats);
+                rootNodes[task.root].fetch_add(nodes, std::memory_order_relaxed);
+                self.stats.nodes += nodes;
+            }
+            pending.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < threads; ++i) {
+        pool.emplace_back(run, i);
+    }
+    run(0);
+    for (auto& thread : pool) {
+        thread.join();
+    }
+
+    for (size_t i = 0; i < rootMoves.size(); ++i) {
+        result.divide[i].nodes = rootNodes[i].load();
+    }
+    for (unsigned i = 0; i < threads; ++i) {
+        result.threads[i] = workers[i]->stats;
+    }
+    return result;
+}
+
+std::string Perft::moveToString(const Move& move)
+{
+    std::string text{
+        static_cast<char>('a' + move.from.x),
+        static_cast<char>('8' - move.from.y),
+        static_cast<char>('a' + move.to.x),
+        static_cast<char>('8' - move.to.y)
+    };
+
+    switch (move.promotion) {
+    case PIECE::Queen: text.push_back('q'); break;
+    case PIECE::Rook: text.push_back('r'); break;
+    case PIECE::Bishop: text.push_back('b'); break;
+    case PIECE::Knight: text.push_back('n'); break;
+    default: break;
+    }
+    return text;
+}
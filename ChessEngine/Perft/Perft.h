@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Core/Core.h"
+#include "PerftHash.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Perft {
+
+	struct DivideEntry {
+		Move move;
+		uint64_t nodes;
+	};
+
+	struct ThreadStats {
+		uint64_t nodes = 0;     // leaves credited by this thread
+		uint64_t tasks = 0;     // subtrees executed
+		uint64_t steals = 0;    // tasks taken from another thread's deque
+		uint64_t hashHits = 0;
+	};
+
+	struct ParallelResult {
+		std::vector<DivideEntry> divide;
+		std::vector<ThreadStats> threads;
+	};
+
+	// Leaf count of the legal move tree below `board`. The last ply is not played:
+	// the size of its move list is the number of leaves (bulk counting).
+	// With a hash, subtree counts are cached by (key, depth).
+	uint64_t count(Core& board, int depth, PerftHash* hash = nullptr, ThreadStats* stats = nullptr);
+
+	// Same tree from `root`, split per root move
+	std::vector<DivideEntry> divide(Position root, int depth);
+
+	// Divide over `threads` workers. The top plies are expanded into subtree tasks
+	// spread over per-thread work-stealing deques; all workers share `hash`.
+	ParallelResult divideParallel(Position root, int depth, unsigned threads, PerftHash& hash);
+
+	// Coordinate notation: e2e4, e7e8q
+	std::string moveToString(const Move& move);
+}
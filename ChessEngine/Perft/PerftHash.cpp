@@ -0,0 +1,40 @@
+#include "PerftHash.h"
+
+PerftHash::PerftHash(size_t megabytes)
+{
+    const size_t count = hashSlotCount(megabytes, sizeof(Entry));
+    if (count == 0) {
+        return;
+    }
+
+    entries = std::make_unique<Entry[]>(count);
+    mask = count - 1;
+}
+
+bool PerftHash::probe(uint64_t key, int depth, uint64_t& nodes) const
+{
+    if (!entries) {
+        return false;
+    }
+
+    const Entry& entry = entries[key & mask];
+    uint64_t entryKey = 0;
+    uint64_t data = 0;
+    entry.load(entryKey, data);
+    if (entryKey != key || static_cast<int>(data & 0xFF) != depth) {
+        return false;
+    }
+
+    nodes = data >> 8;
+    return true;
+}
+
+void PerftHash::store(uint64_t key, int depth, uint64_t nodes)
+{
+    if (!entries) {
+        return;
+    }
+
+    const uint64_t data = (nodes << 8) | static_cast<uint64_t>(depth & 0xFF);
+    entries[key & mask].save(key, data);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Core/LocklessEntry.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Shared perft cache keyed by Zobrist hash and remaining depth, safe to use from
+// many threads without locks through LocklessEntry.
+class PerftHash {
+
+public:
+	// 0 MB disables the table
+	explicit PerftHash(size_t megabytes);
+
+	bool probe(uint64_t key, int depth, uint64_t& nodes) const;
+	void store(uint64_t key, int depth, uint64_t nodes);
+
+	[[nodiscard]] bool enabled() const { return entries != nullptr; }
+
+private:
+	// data: nodes << 8 | depth
+	using Entry = LocklessEntry;
+
+	std::unique_ptr<Entry[]> entries;
+	size_t mask = 0;
+};
@@ -0,0 +1,134 @@
+#include "Perft.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace
+{
+    void printUsage()
+    {
+        std::cerr << "Usage: perft [-t threads] [-H hashMB] [-b] <depth> [fen]\n"
+                  << "  -t  worker threads (default 1)\n"
+                  << "  -H  shared perft cache size in MB (default 0, disabled)\n"
+                  << "  -b  also run single-threaded first and report speedup and efficiency\n";
+    }
+
+    double secondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+// The FEN may be passed quoted or as separate arguments. Defaults to the start position.
+int main(int argc, char** argv)
+{
+    unsigned threads = 1;
+    size_t hashMegabytes = 0;
+    bool baseline = false;
+
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-'; ++arg) {
+        const std::string_view option = argv[arg];
+        if (option == "-b") {
+            baseline = true;
+        } else if (option == "-t" && arg + 1 < argc) {
+            threads = static_cast<unsigned>(std::max(1, std::atoi(argv[++arg])));
+        } else if (option == "-H" && arg + 1 < argc) {
+            hashMegabytes = static_cast<size_t>(std::max(0, std::atoi(argv[++arg])));
+        } else {
+            printUsage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (arg >= argc) {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    const int depth = std::atoi(argv[arg++]);
+    if (depth < 1) {
+        std::cerr << "Depth must be at least 1\n";
+        return EXIT_FAILURE;
+    }
+
+    std::string fen;
+    for (; arg < argc; ++arg) {
+        if (!fen.empty()) {
+            fen.push_back(' ');
+        }
+        fen += argv[arg];
+    }
+    if (fen.empty()) {
+        fen = Core::START_FEN;
+    }
+
+    Core board;
+    if (!board.fromFEN(fen)) {
+        std::cerr << "Invalid FEN: " << fen << "\n";
+        return EXIT_FAILURE;
+    }
+
+    // Plain single-threaded walk, the reference for correctness
+    if (threads == 1 && hashMegabytes == 0 && !baseline) {
+        const auto start = std::chrono::steady_clock::now();
+        const auto entries = Perft::divide(board.snapshot(), depth);
+        const double seconds = secondsSince(start);
+
+        uint64_t total = 0;
+        for (const auto& entry : entries) {
+            std::cout << Perft::moveToString(entry.move) << ": " << entry.nodes << "\n";
+            total += entry.nodes;
+        }
+
+        std::cout << "\nMoves: " << entries.size()
+                  << "\nNodes: " << total
+                  << "\nTime: " << static_cast<uint64_t>(seconds * 1000.0) << " ms"
+                  << "\nNodes/sec: " << (seconds > 0.0 ? static_cast<uint64_t>(static_cast<double>(total) / seconds) : 0) << "\n";
+        return EXIT_SUCCESS;
+    }
+
+    double baselineSeconds = 0.0;
+    if (baseline) {
+        PerftHash baselineHash(hashMegabytes);
+        const auto start = std::chrono::steady_clock::now();
+        (void)Perft::divideParallel(board.snapshot(), depth, 1, baselineHash);
+        baselineSeconds = secondsSince(start);
+    }
+
+    PerftHash hash(hashMegabytes);
+    const auto start = std::chrono::steady_clock::now();
+    const auto result = Perft::divideParallel(board.snapshot(), depth, threads, hash);
+    const double seconds = secondsSince(start);
+
+    uint64_t total = 0;
+    for (const auto& entry : result.divide) {
+        std::cout << Perft::moveToString(entry.move) << ": " << entry.nodes << "\n";
+        total += entry.nodes;
+    }
+
+    std::cout << "\nThread  nodes  tasks  steals  hash hits\n";
+    for (size_t i = 0; i < result.threads.size(); ++i) {
+        const auto& stats = result.threads[i];
+        std::cout << i << "  " << stats.nodes << "  " << stats.tasks << "  " << stats.steals << "  " << stats.hashHits << "\n";
+    }
+
+    std::cout << "\nMoves: " << result.divide.size()
+              << "\nNodes: " << total
+              << "\nThreads: " << threads
+              << "\nHash: " << hashMegabytes << " MB"
+              << "\nTime: " << static_cast<uint64_t>(seconds * 1000.0) << " ms"
+              << "\nNodes/sec: " << (seconds > 0.0 ? static_cast<uint64_t>(static_cast<double>(total) / seconds) : 0) << "\n";
+
+    if (baseline && seconds > 0.0) {
+        const double speedup = baselineSeconds / seconds;
+        std::cout << "Single-thread time: " << static_cast<uint64_t>(baselineSeconds * 1000.0) << " ms"
+                  << "\nSpeedup: " << speedup
+                  << "\nEfficiency: " << (100.0 * speedup / threads) << " %\n";
+    }
+    return EXIT_SUCCESS;
+}
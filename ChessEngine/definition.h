@@ -23,6 +23,16 @@ enum class SIDE : uint8_t {
 	SPECTATOR_SIDE = 2
 };
 
+struct Move {
+	Vec2 from;
+	Vec2 to;
+	// Piece a pawn turns into on the last rank, King (0) when the move does not promote.
+	// No default member initializer so Move stays trivial and MoveList needs no init.
+	PIECE promotion;
+
+	bool operator==(const Move&) const = default;
+};
+
 union BoardCell {
 	uint8_t raw;
 	struct {